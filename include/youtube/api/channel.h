@@ -37,6 +37,9 @@ public:
 
     Channel(const Json::Value &data);
 
+    // What the constructor reads, as a fields= projection
+    static const std::string & fields();
+
     ~Channel() = default;
 
     const std::string & title() const override;
@@ -21,6 +21,8 @@
 #define YOUTUBE_API_CLIENT_H_
 
 #include <youtube/api/config.h>
+#include <youtube/api/dispatcher.h>
+#include <youtube/api/metrics.h>
 #include <youtube/api/channel.h>
 #include <youtube/api/subscription.h>
 #include <youtube/api/subscription-item.h>
@@ -29,6 +31,8 @@
 #include <youtube/api/playlist.h>
 #include <youtube/api/playlist-item.h>
 #include <youtube/api/search-list-response.h>
+#include <youtube/api/task.h>
+#include <youtube/api/worker-pool.h>
 #include <youtube/api/video.h>
 #include <youtube/api/comment.h>
 
@@ -37,6 +41,8 @@
 #include <atomic>
 #include <deque>
 #include <future>
+#include <ostream>
+#include <stdexcept>
 #include <string>
 #include <thread>
 #include <vector>
@@ -70,61 +76,128 @@ public:
 
     virtual ~Client() = default;
 
-    virtual std::future<GuideCategoryList> guide_categories(
+    virtual Task<GuideCategoryList> guide_categories(
             const std::string &region_code, const std::string &locale);
 
-    virtual std::future<SearchListResponse::Ptr> search(
+    virtual Task<SearchListResponse::Ptr> search(
             const std::string &query, unsigned int max_results, const std::string &category_id="");
 
-    virtual std::future<SubscriptionList> subscription_channels();
+    virtual Task<SubscriptionList> subscription_channels();
 
-    virtual std::future<ChannelList> auth_user_info();
+    /*
+     * Every subscription of the user, following the pages of
+     * subscription_channels()
+     */
+    virtual Task<SubscriptionList> all_subscription_channels();
 
-    virtual std::future<std::string> subscription_channel_uploads(std::string const &department_id);
+    virtual Task<ChannelList> auth_user_info();
 
-    virtual std::future<SubscriptionItemList> subscription_items( const std::string &playlistId);
+    virtual Task<std::string> subscription_channel_uploads(std::string const &department_id);
 
-    virtual std::future<ChannelList> category_channels(
+    virtual Task<SubscriptionItemList> subscription_items( const std::string &playlistId);
+
+    virtual Task<ChannelList> category_channels(
             const std::string &categoryId);
 
-    virtual std::future<ChannelList> channels_statistics(
+    /*
+     * Looks up the uploads playlists of the channels not already known,
+     * up to 50 per request. Settles once every batch has, whether it
+     * found them or not. Nothing is saved to disk.
+     */
+    virtual Task<bool> prefetch_uploads(
+            const std::vector<std::string> &channel_ids);
+
+    virtual Task<ChannelList> channels_statistics(
             const std::string &channelId);
 
-    virtual std::future<ChannelSectionList> channel_sections(
+    virtual Task<ChannelSectionList> channel_sections(
             const std::string &channelId, int maxResults);
 
-    virtual std::future<VideoList> channel_videos(const std::string &channelId);
+    /*
+     * The channel's latest uploads, or with by_views the most viewed of
+     * its 50 latest uploads
+     */
+    virtual Task<VideoList> channel_videos(const std::string &channelId,
+            unsigned int max_results = 0, bool by_views = false);
 
-    virtual std::future<VideoList> chart_videos(const std::string &chart_name,
+    virtual Task<VideoList> chart_videos(const std::string &chart_name,
             const std::string &region_code, const std::string &category_id);
 
-    virtual std::future<PlaylistList> channel_playlists(
+    virtual Task<PlaylistList> channel_playlists(
             const std::string &channelId);
 
-    virtual std::future<PlaylistItemList> playlist_items(
+    virtual Task<PlaylistItemList> playlist_items(
             const std::string &playlistId);
 
-    virtual std::future<VideoList> videos(const std::string &videoId);
+    virtual Task<VideoList> videos(const std::string &videoId);
+
+    /*
+     * Only the counts for a video, for when the rest of it is already
+     * known. These are remembered for a minute.
+     */
+    virtual Task<Video::Statistics> video_statistics(
+            const std::string &videoId);
 
-    virtual std::future<CommentList> video_comments(const std::string &videoId);
+    virtual Task<CommentList> video_comments(const std::string &videoId);
     
-    virtual std::future<bool> post_comments(const std::string &videoId, const std::string msg);
+    virtual Task<bool> post_comments(const std::string &videoId, const std::string msg);
 
-    virtual std::future<bool> rate(const std::string &videoId, bool likes);
+    virtual Task<bool> rate(const std::string &videoId, bool likes);
 
-    virtual std::future<Client::SubscriptionList> subscribeId(const std::string &channelId);
+    virtual Task<Client::SubscriptionList> subscribeId(const std::string &channelId);
 
-    virtual std::future<bool> subscribe(const std::string &channelId);
+    /*
+     * Resolves to the id of the new subscription, or empty if the server
+     * did not report one
+     */
+    virtual Task<std::string> subscribe(const std::string &channelId);
     
-    virtual std::future<bool> unSubscribe(const std::string &subscribeId);
+    virtual Task<bool> unSubscribe(const std::string &subscribeId);
     
-    virtual std::future<bool> addVideoIntoPlayList(const std::string &videoId,
+    virtual Task<bool> addVideoIntoPlayList(const std::string &videoId,
                                                    const std::string &playlistId);
 
+    /*
+     * Abort every outstanding request and fail its future with Cancelled.
+     * Requests made afterwards fail straight away.
+     */
     virtual void cancel();
 
+    /*
+     * The class the following requests are dispatched under
+     */
+    virtual void set_priority(Priority priority);
+
+    /*
+     * Whether an account is signed in, and which. These are looked up at
+     * most every few seconds per client, as each look up is a D-Bus call.
+     */
     virtual bool authenticated();
 
+    virtual std::string account_id();
+
+    /*
+     * True when the shared API quota is running out, and callers should
+     * prefer cheaper endpoints
+     */
+    virtual bool quota_low();
+
+    /*
+     * How the response parsing stage shared by all clients is keeping up
+     */
+    virtual WorkerPool::Stats parse_stats();
+
+    /*
+     * Request counts, bytes and latencies per endpoint, shared by all
+     * clients in the process
+     */
+    virtual Metrics::Snapshot metrics();
+
+    /*
+     * Write the metrics and the connection timings in a readable form
+     */
+    virtual void dump_metrics(std::ostream &out);
+
 protected:
     class Priv;
     friend Priv;
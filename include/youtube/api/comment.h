@@ -38,6 +38,10 @@ public:
 
     Comment(const Json::Value &data);
 
+    // What the constructor reads from a comment thread, as a fields=
+    // projection
+    static const std::string & fields();
+
     virtual ~Comment() = default;
 
     const std::string & id() const override;
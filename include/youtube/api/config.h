@@ -67,6 +67,11 @@ struct Config {
      * Have we got access to private APIs?
      */
     bool authenticated = false;
+
+    /*
+     * The online account the access token belongs to
+     */
+    std::string account_id { };
 };
 
 }
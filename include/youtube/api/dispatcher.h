@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef YOUTUBE_API_DISPATCHER_H_
+#define YOUTUBE_API_DISPATCHER_H_
+
+#include <array>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace youtube {
+namespace api {
+
+/*
+ * Request classes, from most to least urgent
+ */
+enum class Priority {
+    interactive, surfacing, search, background
+};
+
+/**
+ * Decides when queued HTTP requests are started.
+ *
+ * Each priority class has its own concurrency limit, and all classes share
+ * an overall limit. When a slot frees up the most urgent queued request is
+ * started first, so a preview never waits behind a department fan-out.
+ */
+class Dispatcher {
+public:
+    typedef std::shared_ptr<Dispatcher> Ptr;
+
+    typedef std::function<void()> Job;
+
+    typedef unsigned long Ticket;
+
+    static constexpr std::size_t PRIORITY_COUNT = 4;
+
+    typedef std::array<unsigned int, PRIORITY_COUNT> Limits;
+
+    Dispatcher(unsigned int max_active, const Limits &limits);
+
+    ~Dispatcher() = default;
+
+    Ticket next_ticket();
+
+    /*
+     * Start the job now if there is room, otherwise queue it.
+     * The owner is any address identifying the submitter.
+     */
+    void submit(Ticket ticket, const void *owner, Priority priority,
+            const Job &job);
+
+    /*
+     * Called when a started job has finished. Unknown or already
+     * finished tickets are ignored.
+     */
+    void done(Ticket ticket);
+
+    /*
+     * Drop the owner's queued jobs and release the slots of its running
+     * ones, e.g. when it will never see them complete
+     */
+    void abandon(const void *owner);
+
+    /*
+     * Drop the job if it is still queued, or release its slot if it has
+     * started
+     */
+    void cancel(Ticket ticket);
+
+    std::size_t queued(Priority priority);
+
+    unsigned int active(Priority priority);
+
+protected:
+    struct Entry {
+        Ticket ticket;
+        const void *owner;
+        Job job;
+    };
+
+    struct Running {
+        const void *owner;
+        Priority priority;
+    };
+
+    void release(std::map<Ticket, Running>::iterator it);
+
+    void take_runnable(std::deque<Job> &runnable);
+
+    void run(std::deque<Job> &runnable);
+
+    unsigned int max_active_;
+
+    Limits limits_;
+
+    Ticket next_ticket_ = 0;
+
+    std::array<unsigned int, PRIORITY_COUNT> active_;
+
+    std::array<std::deque<Entry>, PRIORITY_COUNT> queues_;
+
+    std::map<Ticket, Running> running_;
+
+    std::mutex mutex_;
+};
+
+}
+}
+
+#endif // YOUTUBE_API_DISPATCHER_H_
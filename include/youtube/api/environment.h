@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef YOUTUBE_API_ENVIRONMENT_H_
+#define YOUTUBE_API_ENVIRONMENT_H_
+
+namespace youtube {
+namespace api {
+
+/*
+ * Settings read from the environment. An unset variable gives the
+ * fallback, and so does a value that is not a number in range, which is
+ * logged and otherwise ignored, so a typo never takes the scope down.
+ */
+
+/*
+ * A positive number
+ */
+double env_number(const char *name, double fallback);
+
+/*
+ * A whole number, zero included, e.g. a cache size where zero turns the
+ * cache off
+ */
+unsigned long env_whole(const char *name, unsigned long fallback);
+
+}
+}
+
+#endif // YOUTUBE_API_ENVIRONMENT_H_
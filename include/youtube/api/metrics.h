@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef YOUTUBE_API_METRICS_H_
+#define YOUTUBE_API_METRICS_H_
+
+#include <array>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+namespace youtube {
+namespace api {
+
+/**
+ * A latency histogram in the style of HdrHistogram.
+ *
+ * Values are bucketed by their power of two, and each power of two is
+ * split into 16 linear sub-buckets, so any recorded value is known to
+ * within about 6% from a microsecond up to several days.
+ */
+class Histogram {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    Histogram();
+
+    void record(const Clock::duration &value);
+
+    unsigned long count() const;
+
+    Clock::duration mean() const;
+
+    Clock::duration max() const;
+
+    /*
+     * The value below which the given fraction (0 to 1) of samples fall
+     */
+    Clock::duration percentile(double fraction) const;
+
+protected:
+    static constexpr unsigned int SUB_BUCKETS = 16;
+
+    static constexpr unsigned int BUCKET_COUNT = 37 * SUB_BUCKETS;
+
+    static unsigned int index(unsigned long long micros);
+
+    static unsigned long long lowest(unsigned int index);
+
+    std::array<unsigned long, BUCKET_COUNT> buckets_;
+
+    unsigned long count_ = 0;
+
+    unsigned long long total_ = 0;
+
+    unsigned long long max_ = 0;
+};
+
+/**
+ * Counters and latency histograms for each API endpoint, e.g.
+ * "search" or "videos/rate".
+ */
+class Metrics {
+public:
+    typedef std::shared_ptr<Metrics> Ptr;
+
+    typedef Histogram::Clock Clock;
+
+    enum class Phase {
+        // Waiting in the dispatcher for a connection slot
+        queue,
+        // From starting the request until the whole response is in
+        transfer,
+        // Decompressing, parsing and building the models
+        parse
+    };
+
+    static constexpr std::size_t PHASE_COUNT = 3;
+
+    struct Endpoint {
+        unsigned long requests = 0;
+
+        unsigned long errors = 0;
+
+        unsigned long cache_hits = 0;
+
+        unsigned long long bytes_out = 0;
+
+        // As received, and after decompression
+        unsigned long long bytes_in = 0;
+
+        unsigned long long bytes_decoded = 0;
+
+        std::array<Histogram, PHASE_COUNT> latency;
+    };
+
+    typedef std::map<std::string, Endpoint> Snapshot;
+
+    Metrics() = default;
+
+    ~Metrics() = default;
+
+    void sent(const std::string &endpoint, std::size_t bytes);
+
+    void received(const std::string &endpoint, std::size_t bytes);
+
+    void decoded(const std::string &endpoint, std::size_t bytes);
+
+    void failed(const std::string &endpoint);
+
+    void cache_hit(const std::string &endpoint);
+
+    void record(const std::string &endpoint, Phase phase,
+            const Clock::duration &latency);
+
+    Snapshot snapshot();
+
+    /*
+     * One line per endpoint and phase, for logs
+     */
+    void dump(std::ostream &out);
+
+protected:
+    Snapshot endpoints_;
+
+    std::mutex mutex_;
+};
+
+}
+}
+
+#endif // YOUTUBE_API_METRICS_H_
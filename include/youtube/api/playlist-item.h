@@ -37,6 +37,9 @@ public:
 
     PlaylistItem(const Json::Value &data);
 
+    // What the constructor reads, as a fields= projection
+    static const std::string & fields();
+
     virtual ~PlaylistItem() = default;
 
     const std::string & title() const override;
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef YOUTUBE_API_QUOTA_H_
+#define YOUTUBE_API_QUOTA_H_
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace youtube {
+namespace api {
+
+/**
+ * Accounts for the YouTube Data API quota units spent by the scope.
+ *
+ * Every request is charged the cost of its endpoint against a token bucket
+ * (the short term rate limit) and against a daily budget. Callers ask
+ * reserve() before issuing a request and are told how long to hold it back.
+ */
+class Quota {
+public:
+    typedef std::shared_ptr<Quota> Ptr;
+
+    typedef std::chrono::steady_clock Clock;
+
+    struct Usage {
+        unsigned long requests = 0;
+        unsigned long units = 0;
+    };
+
+    typedef std::map<std::string, Usage> UsageMap;
+
+    Quota(unsigned long daily_budget, double bucket_capacity,
+            double refill_per_second);
+
+    ~Quota() = default;
+
+    /*
+     * The quota cost of a call to the given endpoint, e.g. "search"
+     * or "videos/rate". Writes are always charged the insert cost.
+     */
+    static unsigned int cost(const std::string &endpoint, bool write);
+
+    /*
+     * Charge a request to the endpoint. Returns false if the request must
+     * be refused, otherwise sets delay to how long it should be held back.
+     */
+    bool reserve(const std::string &endpoint, bool write,
+            std::chrono::milliseconds &delay);
+
+    /*
+     * Give back a reservation whose request was never sent
+     */
+    void refund(const std::string &endpoint, bool write);
+
+    /*
+     * True if either the bucket or the daily budget is nearly drained,
+     * and callers should choose cheaper endpoints where they can.
+     */
+    bool low();
+
+    unsigned long remaining();
+
+    UsageMap usage();
+
+protected:
+    void refill(const Clock::time_point &now);
+
+    unsigned long daily_budget_;
+
+    double capacity_;
+
+    double rate_;
+
+    double tokens_;
+
+    unsigned long spent_ = 0;
+
+    Clock::time_point last_refill_;
+
+    Clock::time_point day_start_;
+
+    UsageMap usage_;
+
+    std::mutex mutex_;
+};
+
+}
+}
+
+#endif // YOUTUBE_API_QUOTA_H_
@@ -23,6 +23,7 @@
 
 #include <deque>
 #include <memory>
+#include <string>
 
 namespace Json {
 class Value;
@@ -39,6 +40,12 @@ public:
 
     SearchListResponse(const Json::Value &data);
 
+    /*
+     * What the constructor reads besides the items, which are projected
+     * with the fields of their own model
+     */
+    static const std::string & fields();
+
     ~SearchListResponse() = default;
 
     ResourceList items();
@@ -36,6 +36,9 @@ public:
 
     SubscriptionItem(const Json::Value &data);
 
+    // What the constructor reads, as a fields= projection
+    static const std::string & fields();
+
     ~SubscriptionItem() = default;
 
     const std::string & title() const override;
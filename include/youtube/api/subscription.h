@@ -37,6 +37,9 @@ public:
 
     Subscription(const Json::Value &data);
 
+    // What the constructor reads, as a fields= projection
+    static const std::string & fields();
+
     ~Subscription() = default;
 
     const std::string & title() const override;
@@ -0,0 +1,297 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef YOUTUBE_API_TASK_H_
+#define YOUTUBE_API_TASK_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace youtube {
+namespace api {
+
+/*
+ * The error a task fails with when it is cancelled, or when the client
+ * behind it is
+ */
+class Cancelled: public std::domain_error {
+public:
+    Cancelled() :
+            std::domain_error("Request cancelled") {
+    }
+};
+
+template<typename T>
+class Task;
+
+namespace internal {
+
+/*
+ * How the result of a continuation settles the task then() returned.
+ * A continuation may return a plain value, or another task to wait for.
+ */
+template<typename R>
+struct Chain {
+    typedef Task<R> Next;
+
+    template<typename F, typename T>
+    static void run(const Next &next, F &f, const T &value) {
+        next.set_value(f(value));
+    }
+};
+
+template<typename R>
+struct Chain<Task<R>> {
+    typedef Task<R> Next;
+
+    template<typename F, typename T>
+    static void run(const Next &next, F &f, const T &value) {
+        Next inner = f(value);
+        next.on_cancel([inner]() {
+            inner.cancel();
+        });
+        inner.forward(next);
+    }
+};
+
+}
+
+/**
+ * The result of an asynchronous operation, which can be waited on like a
+ * std::future or composed with then().
+ *
+ * A Task is a handle, copies share the same result. The first of
+ * set_value() or set_exception() settles it and later calls are ignored,
+ * so a response and a cancellation can safely race.
+ *
+ * Continuations run on the thread that settles the task, usually one of
+ * the response parsers, or straight away if it is already settled. They
+ * must not block.
+ *
+ * Cancelling a task fails it with Cancelled and runs the cancellers its
+ * producer registered, so a request nobody wants any more stops using
+ * the connection and the quota. Cancelling a continuation's task cancels
+ * what it is waiting on.
+ */
+template<typename T>
+class Task {
+public:
+    Task() :
+            state_(std::make_shared<State>()) {
+    }
+
+    static Task<T> ready(const T &value) {
+        Task<T> task;
+        task.set_value(value);
+        return task;
+    }
+
+    static Task<T> failed(std::exception_ptr error) {
+        Task<T> task;
+        task.set_exception(error);
+        return task;
+    }
+
+    void set_value(const T &value) const {
+        settle(std::make_shared<T>(value), nullptr);
+    }
+
+    void set_exception(std::exception_ptr error) const {
+        settle(nullptr, error);
+    }
+
+    /*
+     * Gives up on the result, unless the task has already settled
+     */
+    void cancel() const {
+        std::vector<std::function<void()>> cancellers;
+        {
+            std::lock_guard<std::mutex> lock(state_->mutex_);
+            if (state_->settled_) {
+                return;
+            }
+            cancellers.swap(state_->cancellers_);
+        }
+        for (const auto &canceller : cancellers) {
+            canceller();
+        }
+        set_exception(std::make_exception_ptr(Cancelled()));
+    }
+
+    /*
+     * Calls canceller if the task is cancelled before it settles
+     */
+    void on_cancel(const std::function<void()> &canceller) const {
+        std::lock_guard<std::mutex> lock(state_->mutex_);
+        if (!state_->settled_) {
+            state_->cancellers_.emplace_back(canceller);
+        }
+    }
+
+    template<typename Rep, typename Period>
+    std::future_status wait_for(
+            const std::chrono::duration<Rep, Period> &timeout) const {
+        std::unique_lock<std::mutex> lock(state_->mutex_);
+        std::shared_ptr<State> state = state_;
+        return state_->settled_cond_.wait_for(lock, timeout, [state]() {
+            return state->settled_;
+        }) ? std::future_status::ready : std::future_status::timeout;
+    }
+
+    /*
+     * Blocks until settled, then returns the value or rethrows the error
+     */
+    T get() const {
+        std::unique_lock<std::mutex> lock(state_->mutex_);
+        std::shared_ptr<State> state = state_;
+        state_->settled_cond_.wait(lock, [state]() {
+            return state->settled_;
+        });
+        if (state_->error_) {
+            std::rethrow_exception(state_->error_);
+        }
+        return *state_->value_;
+    }
+
+    /*
+     * Calls f(value) once this task succeeds. Errors skip f and are passed
+     * straight on to the returned task, as is anything f throws.
+     */
+    template<typename F>
+    typename internal::Chain<
+            typename std::result_of<F(const T &)>::type>::Next then(F f) const {
+        typedef internal::Chain<typename std::result_of<F(const T &)>::type> Chain;
+
+        typename Chain::Next next;
+        Task<T> self = *this;
+        next.on_cancel([self]() {
+            self.cancel();
+        });
+        std::shared_ptr<State> state = state_;
+        subscribe([state, next, f]() mutable {
+            if (state->error_) {
+                next.set_exception(state->error_);
+                return;
+            }
+            try {
+                Chain::run(next, f, *state->value_);
+            } catch (...) {
+                next.set_exception(std::current_exception());
+            }
+        });
+        return next;
+    }
+
+    /*
+     * Settle other with this task's result once it is known
+     */
+    void forward(Task<T> other) const {
+        std::shared_ptr<State> state = state_;
+        subscribe([state, other]() {
+            if (state->error_) {
+                other.set_exception(state->error_);
+            } else {
+                other.set_value(*state->value_);
+            }
+        });
+    }
+
+    /*
+     * Calls back once settled, whether it succeeded or not
+     */
+    void finally(const std::function<void()> &callback) const {
+        subscribe(callback);
+    }
+
+    std::future<T> future() const {
+        auto prom = std::make_shared<std::promise<T>>();
+        std::shared_ptr<State> state = state_;
+        subscribe([state, prom]() {
+            if (state->error_) {
+                prom->set_exception(state->error_);
+            } else {
+                prom->set_value(*state->value_);
+            }
+        });
+        return prom->get_future();
+    }
+
+protected:
+    struct State {
+        std::mutex mutex_;
+
+        std::condition_variable settled_cond_;
+
+        bool settled_ = false;
+
+        std::shared_ptr<T> value_;
+
+        std::exception_ptr error_;
+
+        std::vector<std::function<void()>> callbacks_;
+
+        std::vector<std::function<void()>> cancellers_;
+    };
+
+    void settle(const std::shared_ptr<T> &value,
+            std::exception_ptr error) const {
+        std::vector<std::function<void()>> callbacks;
+        std::vector<std::function<void()>> cancellers;
+        {
+            std::lock_guard<std::mutex> lock(state_->mutex_);
+            if (state_->settled_) {
+                return;
+            }
+            state_->settled_ = true;
+            state_->value_ = value;
+            state_->error_ = error;
+            callbacks.swap(state_->callbacks_);
+            // Released outside the lock, they may hold other tasks
+            cancellers.swap(state_->cancellers_);
+        }
+        state_->settled_cond_.notify_all();
+
+        for (const auto &callback : callbacks) {
+            callback();
+        }
+    }
+
+    void subscribe(const std::function<void()> &callback) const {
+        {
+            std::lock_guard<std::mutex> lock(state_->mutex_);
+            if (!state_->settled_) {
+                state_->callbacks_.emplace_back(callback);
+                return;
+            }
+        }
+        callback();
+    }
+
+    std::shared_ptr<State> state_;
+};
+
+}
+}
+
+#endif // YOUTUBE_API_TASK_H_
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef YOUTUBE_API_TIMER_H_
+#define YOUTUBE_API_TIMER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace youtube {
+namespace api {
+
+/**
+ * Runs jobs once their delay has passed, on a thread of its own.
+ *
+ * Used to hold work back without blocking the thread that asked for it,
+ * e.g. a request waiting for quota. Jobs run in order of their due time
+ * and must not block. Jobs not yet due are dropped when the timer is
+ * destroyed.
+ */
+class Timer {
+public:
+    typedef std::function<void()> Job;
+
+    typedef std::chrono::steady_clock Clock;
+
+    Timer();
+
+    ~Timer();
+
+    void schedule(const Clock::duration &delay, const Job &job);
+
+    std::size_t pending();
+
+    static Timer & instance();
+
+protected:
+    void work();
+
+    std::multimap<Clock::time_point, Job> jobs_;
+
+    bool stopping_ = false;
+
+    std::mutex mutex_;
+
+    std::condition_variable jobs_cond_;
+
+    std::thread thread_;
+};
+
+}
+}
+
+#endif // YOUTUBE_API_TIMER_H_
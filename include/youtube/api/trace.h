@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef YOUTUBE_API_TRACE_H_
+#define YOUTUBE_API_TRACE_H_
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace youtube {
+namespace api {
+
+/**
+ * Collects timed spans and writes them out in the Chrome trace event
+ * format, which chrome://tracing and Perfetto can load.
+ *
+ * Tracing is off unless YOUTUBE_SCOPE_TRACE names the file to write to.
+ * The file is rewritten on every flush(), and when the process exits.
+ */
+class Tracer {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    static Tracer & instance();
+
+    ~Tracer();
+
+    bool enabled() const;
+
+    /*
+     * A span that ran on the calling thread. Spans on the same thread nest
+     * by time.
+     */
+    void complete(const std::string &name, const std::string &category,
+            const Clock::time_point &start, const Clock::time_point &end);
+
+    /*
+     * A span that is not tied to one thread, such as an HTTP request
+     */
+    void async(const std::string &name, const std::string &category,
+            unsigned long id, const Clock::time_point &start,
+            const Clock::time_point &end);
+
+    void flush();
+
+protected:
+    struct Event {
+        std::string name;
+
+        std::string category;
+
+        char phase;
+
+        unsigned long id;
+
+        long long timestamp;
+
+        long long duration;
+
+        std::size_t thread;
+    };
+
+    Tracer(const std::string &path);
+
+    void add(const Event &event);
+
+    long long micros(const Clock::time_point &time) const;
+
+    std::string path_;
+
+    Clock::time_point epoch_;
+
+    std::vector<Event> events_;
+
+    std::mutex mutex_;
+};
+
+/**
+ * Times its own scope, e.g. one phase of a query
+ */
+class Span {
+public:
+    Span(const std::string &name, const std::string &category = "scope");
+
+    ~Span();
+
+    Span(const Span&) = delete;
+
+    Span & operator=(const Span&) = delete;
+
+protected:
+    std::string name_;
+
+    std::string category_;
+
+    Tracer::Clock::time_point start_;
+};
+
+}
+}
+
+#endif // YOUTUBE_API_TRACE_H_
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef YOUTUBE_API_TYPED_LIST_H_
+#define YOUTUBE_API_TYPED_LIST_H_
+
+#include <json/json.h>
+
+#include <deque>
+#include <memory>
+#include <string>
+
+namespace youtube {
+namespace api {
+
+/**
+ * Builds a T from each entry of a list response's items whose kind
+ * matches filter. Search results are matched on the kind of their id.
+ */
+template<typename T>
+std::deque<std::shared_ptr<T>> get_typed_list(const std::string &filter,
+        const Json::Value &root) {
+    std::deque<std::shared_ptr<T>> results;
+    Json::Value data = root["items"];
+    for (Json::ArrayIndex index = 0; index < data.size(); ++index) {
+        Json::Value item = data[index];
+
+        std::string kind = item["kind"].asString();
+        if (kind == "youtube#searchResult") {
+            kind = item["id"]["kind"].asString();
+        }
+
+        if (kind == filter) {
+            results.emplace_back(std::make_shared<T>(item));
+        }
+    }
+    return results;
+}
+
+}
+}
+
+#endif // YOUTUBE_API_TYPED_LIST_H_
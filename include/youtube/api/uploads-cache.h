@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef YOUTUBE_API_UPLOADS_CACHE_H_
+#define YOUTUBE_API_UPLOADS_CACHE_H_
+
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace youtube {
+namespace api {
+
+/**
+ * Maps channel ids to their uploads playlist id.
+ *
+ * These never change, so they are shared between all clients and can be
+ * kept in a file across runs of the scope. Least recently used entries are
+ * evicted once it is full, so neither the map nor the file grow without
+ * limit.
+ */
+class UploadsCache {
+public:
+    UploadsCache(std::size_t capacity = DEFAULT_CAPACITY);
+
+    ~UploadsCache() = default;
+
+    bool get(const std::string &channel_id, std::string &uploads);
+
+    void put(const std::string &channel_id, const std::string &uploads);
+
+    /*
+     * Reads what an earlier run saved to path, and saves there from now on
+     */
+    void persist(const std::string &path);
+
+    /*
+     * Writes the map to the persisted file, if anything was added since
+     * the last save. This does file I/O, so keep it off the parser pool.
+     */
+    void save();
+
+    std::size_t size();
+
+    void clear();
+
+    /*
+     * The cache shared by all clients, holding up to
+     * YOUTUBE_SCOPE_UPLOADS_CACHE_SIZE channels
+     */
+    static UploadsCache & instance();
+
+    static constexpr std::size_t DEFAULT_CAPACITY = 5000;
+
+protected:
+    typedef std::list<std::pair<std::string, std::string>> Entries;
+
+    /*
+     * Makes room for and adds an entry that is not in the map yet, as the
+     * most recently used one if fresh, else as the least recently used
+     */
+    void insert(const std::string &channel_id, const std::string &uploads,
+            bool fresh);
+
+    std::size_t capacity_;
+
+    // Most recently used first
+    Entries entries_;
+
+    std::unordered_map<std::string, Entries::iterator> index_;
+
+    std::string path_;
+
+    bool dirty_ = false;
+
+    std::mutex mutex_;
+};
+
+}
+}
+
+#endif // YOUTUBE_API_UPLOADS_CACHE_H_
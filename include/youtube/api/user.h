@@ -38,6 +38,10 @@ public:
 
     User(const Json::Value &data);
 
+    // What the constructor reads from a comment's snippet, as a fields=
+    // projection
+    static const std::string & fields();
+
     virtual ~User() = default;
 
     const std::string & title() const override;
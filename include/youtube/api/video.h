@@ -46,6 +46,21 @@ public:
 
     Video(const Json::Value &data);
 
+    /*
+     * What the constructor reads from a video, in the syntax of the API's
+     * fields= parameter. Search results and uploads playlist entries keep
+     * the same details in different places, so have projections of their
+     * own.
+     */
+    static const std::string & fields();
+
+    static const std::string & search_fields();
+
+    static const std::string & upload_fields();
+
+    // Just enough for a video's statistics
+    static const std::string & statistics_fields();
+
     virtual ~Video() = default;
 
     const std::string & title() const override;
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef YOUTUBE_API_WORKER_POOL_H_
+#define YOUTUBE_API_WORKER_POOL_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace youtube {
+namespace api {
+
+/**
+ * A fixed set of threads running posted jobs in FIFO order.
+ *
+ * Used to take CPU work such as decompression and JSON parsing off the
+ * HTTP event loops. Jobs already queued still run when the pool is
+ * destroyed. The pool keeps count of how deep its queue gets and how long
+ * jobs spend in it.
+ */
+class WorkerPool {
+public:
+    typedef std::shared_ptr<WorkerPool> Ptr;
+
+    typedef std::function<void()> Job;
+
+    typedef std::chrono::steady_clock Clock;
+
+    struct Stats {
+        // Jobs waiting for a thread right now
+        std::size_t queued = 0;
+
+        std::size_t peak_queued = 0;
+
+        unsigned long completed = 0;
+
+        // Totals over the completed jobs
+        Clock::duration waiting = Clock::duration::zero();
+
+        Clock::duration running = Clock::duration::zero();
+    };
+
+    WorkerPool(unsigned int threads);
+
+    ~WorkerPool();
+
+    void post(const Job &job);
+
+    std::size_t queued();
+
+    std::size_t size() const;
+
+    Stats stats();
+
+    /*
+     * A single thread for slow housekeeping, such as account checks and
+     * file writes, that must hold up neither the parsers nor the timer
+     */
+    static WorkerPool & background();
+
+protected:
+    struct Queued {
+        Job job;
+        Clock::time_point posted;
+    };
+
+    void work();
+
+    std::deque<Queued> jobs_;
+
+    Stats stats_;
+
+    bool stopping_ = false;
+
+    std::mutex mutex_;
+
+    std::condition_variable jobs_cond_;
+
+    std::vector<std::thread> threads_;
+};
+
+}
+}
+
+#endif // YOUTUBE_API_WORKER_POOL_H_
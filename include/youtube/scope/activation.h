@@ -21,6 +21,7 @@
 #define SCOPE_ACTIVATIOIN_H_
 
 #include <youtube/api/client.h>
+#include <youtube/scope/subscription-index.h>
 
 #include <unity/scopes/ActivationQueryBase.h>
 
@@ -45,7 +46,8 @@ public:
     Activation(const unity::scopes::Result &result,
            const unity::scopes::ActionMetadata & metadata,
            std::string const& action_id,
-           std::shared_ptr<unity::scopes::OnlineAccountClient> oa_client);
+           std::shared_ptr<unity::scopes::OnlineAccountClient> oa_client,
+           SubscriptionIndex::Ptr subscriptions = SubscriptionIndex::Ptr());
 
     ~Activation() = default;
 
@@ -58,6 +60,8 @@ private:
     std::string const action_id_;
     
     youtube::api::Client client_;
+
+    SubscriptionIndex::Ptr subscriptions_;
 };
 
 }
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef YOUTUBE_SCOPE_CHART_CACHE_H_
+#define YOUTUBE_SCOPE_CHART_CACHE_H_
+
+#include <youtube/api/client.h>
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace youtube {
+namespace scope {
+
+/**
+ * The most popular videos per region and video category.
+ *
+ * Aggregating scopes ask for these often and with tight deadlines, so
+ * they are kept for a while and refreshed by a ChartRefresher.
+ */
+class ChartCache {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    // The category the music aggregator asks for
+    static const std::string MUSIC_CATEGORY_ID;
+
+    ChartCache(const Clock::duration &ttl);
+
+    ~ChartCache() = default;
+
+    Clock::duration ttl() const;
+
+    static std::string key(const std::string &region,
+            const std::string &category_id);
+
+    bool get(const std::string &key, api::Client::VideoList &videos);
+
+    void put(const std::string &key, const api::Client::VideoList &videos);
+
+    /*
+     * Fetches the chart and stores it once it arrives, unless the cache
+     * has gone by then
+     */
+    api::Task<api::Client::VideoList> fetch(api::Client &client,
+            const std::string &region, const std::string &category_id);
+
+    void clear();
+
+    /*
+     * The cache used by queries, keeping charts for
+     * YOUTUBE_SCOPE_CHART_CACHE_TTL seconds
+     */
+    static ChartCache & instance();
+
+protected:
+    struct Entry {
+        api::Client::VideoList videos;
+
+        Clock::time_point stored;
+    };
+
+    // Shared with the fetches still in flight
+    struct Store {
+        std::map<std::string, Entry> entries;
+
+        std::mutex mutex;
+    };
+
+    static void put(Store &store, const std::string &key,
+            const api::Client::VideoList &videos);
+
+    Clock::duration ttl_;
+
+    std::shared_ptr<Store> store_;
+};
+
+}
+}
+
+#endif // YOUTUBE_SCOPE_CHART_CACHE_H_
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef YOUTUBE_SCOPE_CHART_REFRESHER_H_
+#define YOUTUBE_SCOPE_CHART_REFRESHER_H_
+
+#include <youtube/scope/chart-cache.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace youtube {
+namespace scope {
+
+/**
+ * Keeps the charts that queries have recently asked for fresh in a
+ * ChartCache, so that they can be served from memory.
+ *
+ * Each chart is refreshed about as often as it is asked for, between
+ * the minimum interval and two thirds of the cache's TTL. Charts nobody
+ * has asked for in an hour are dropped.
+ */
+class ChartRefresher {
+public:
+    typedef std::shared_ptr<ChartRefresher> Ptr;
+
+    typedef ChartCache::Clock Clock;
+
+    ChartRefresher(ChartCache &cache, std::shared_ptr<api::Client> client,
+            const Clock::duration &min_interval);
+
+    ~ChartRefresher();
+
+    /*
+     * Notes that a query wanted the chart, which it fetches itself if the
+     * cache does not have it
+     */
+    void requested(const std::string &region, const std::string &category_id);
+
+    /*
+     * Refreshes every chart the aggregators use for the region now
+     */
+    void warm(const std::string &region);
+
+    /*
+     * How long the chart waits between refreshes, or zero if it is not
+     * being kept fresh
+     */
+    Clock::duration interval(const std::string &region,
+            const std::string &category_id);
+
+    /*
+     * A refresher for ChartCache::instance(), refreshing no more often
+     * than every YOUTUBE_SCOPE_CHART_REFRESH_MIN seconds
+     */
+    static Ptr create(std::shared_ptr<api::Client> client);
+
+protected:
+    struct Watched {
+        std::string region;
+
+        std::string category_id;
+
+        Clock::time_point last_requested;
+
+        // Smoothed time between requests, zero until the second one
+        Clock::duration mean_gap;
+
+        Clock::time_point refreshed;
+    };
+
+    Clock::duration interval(const Watched &watched) const;
+
+    void run();
+
+    ChartCache &cache_;
+
+    std::shared_ptr<api::Client> client_;
+
+    Clock::duration min_interval_;
+
+    Clock::duration max_interval_;
+
+    Clock::duration idle_;
+
+    std::map<std::string, Watched> watched_;
+
+    bool stopping_ = false;
+
+    std::mutex mutex_;
+
+    std::condition_variable wake_cond_;
+
+    std::thread thread_;
+};
+
+}
+}
+
+#endif // YOUTUBE_SCOPE_CHART_REFRESHER_H_
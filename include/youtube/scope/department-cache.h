@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef YOUTUBE_SCOPE_DEPARTMENT_CACHE_H_
+#define YOUTUBE_SCOPE_DEPARTMENT_CACHE_H_
+
+#include <unity/scopes/CannedQuery.h>
+#include <unity/scopes/Department.h>
+
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace youtube {
+namespace scope {
+
+/**
+ * The department trees built by surfacing queries, one per region, locale
+ * and account.
+ *
+ * A tree lists the account's subscriptions, so every tree is dropped when
+ * the user subscribes or unsubscribes. Trees built from the subscriptions
+ * as they were before such a change are not stored.
+ */
+class DepartmentCache {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Tree {
+        // Null if there were no departments to show
+        unity::scopes::Department::SCPtr root;
+
+        // The department shown on the initial surfacing screen
+        std::string first_category_id;
+    };
+
+    DepartmentCache(const Clock::duration &ttl);
+
+    ~DepartmentCache() = default;
+
+    static std::string key(const std::string &region,
+            const std::string &locale, bool authenticated,
+            const std::string &account_id);
+
+    bool get(const std::string &key, Tree &tree);
+
+    /*
+     * Stores the tree if the subscriptions have not changed since
+     * version() was read, before it was built
+     */
+    void put(const std::string &key, const Tree &tree, unsigned long version);
+
+    unsigned long version();
+
+    void subscriptions_changed();
+
+    void clear();
+
+    /*
+     * The departments to register for query: the tree stored under key,
+     * pointing at query, with department_id added under the root unless
+     * it is empty. They are built once per query and kept with the tree,
+     * so a query seen before gets the same departments back.
+     */
+    unity::scopes::Department::SCPtr bind(const std::string &key,
+            const Tree &tree, const unity::scopes::CannedQuery &query,
+            const std::string &department_id = std::string());
+
+    /*
+     * Builds the tree's departments, pointing at query. Each department
+     * carries the query it was made with, so the ones stored with the
+     * tree, from whichever query built it, are never handed out.
+     */
+    static unity::scopes::Department::SCPtr for_query(const Tree &tree,
+            const unity::scopes::CannedQuery &query);
+
+    /*
+     * As for_query(), with one more department under the root. Used to
+     * give a department reached from a result somewhere to live.
+     */
+    static unity::scopes::Department::SCPtr with_subdepartment(
+            const Tree &tree, const unity::scopes::CannedQuery &query,
+            const std::string &department_id);
+
+    /*
+     * The cache used by queries, keeping trees for
+     * YOUTUBE_SCOPE_DEPARTMENT_CACHE_TTL seconds
+     */
+    static DepartmentCache & instance();
+
+protected:
+    struct Entry {
+        Tree tree;
+
+        Clock::time_point stored;
+
+        // The tree bound to the queries that asked for it, see bind()
+        std::map<std::string, unity::scopes::Department::SCPtr> bound;
+    };
+
+    // Every channel and playlist visited binds the tree once more
+    static constexpr std::size_t MAX_BOUND = 64;
+
+    Clock::duration ttl_;
+
+    unsigned long version_ = 0;
+
+    // There are only ever a handful of keys
+    std::map<std::string, Entry> entries_;
+
+    std::mutex mutex_;
+};
+
+}
+}
+
+#endif // YOUTUBE_SCOPE_DEPARTMENT_CACHE_H_
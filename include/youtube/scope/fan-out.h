@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef YOUTUBE_SCOPE_FANOUT_H_
+#define YOUTUBE_SCOPE_FANOUT_H_
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+
+namespace youtube {
+namespace scope {
+
+/**
+ * Runs one request per input with a bounded number outstanding at once,
+ * and hands the results back in input order.
+ *
+ * The width adapts to what the requests observe: it halves when a request
+ * fails or is slower than the target latency, and grows by one after a full
+ * window of healthy responses. A FanOut is meant to be shared, so that what
+ * one query learns applies to the next.
+ */
+class FanOut {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    FanOut(unsigned int width, unsigned int min_width, unsigned int max_width,
+            const std::chrono::milliseconds &target_latency);
+
+    ~FanOut() = default;
+
+    unsigned int width();
+
+    /*
+     * Fix the width, turning off adaptation
+     */
+    void pin(unsigned int width);
+
+    void record(const Clock::duration &latency, bool failed);
+
+    /*
+     * Shared by every query, so what one department fan-out learns about
+     * the server carries over to the next. The width can be pinned with
+     * YOUTUBE_SCOPE_FANOUT_WIDTH.
+     */
+    static FanOut & shared();
+
+    /*
+     * Calls start(input) for each input, and consume(input, result) as the
+     * results arrive. Errors from the requests are rethrown, and the
+     * requests still outstanding then are cancelled.
+     */
+    template<typename Inputs, typename Start, typename Consume>
+    void run(const Inputs &inputs, Start start, Consume consume) {
+        run(inputs, start, consume, [](std::size_t) {
+            return true;
+        });
+    }
+
+    /*
+     * As above, but only starts another request while wanted(outstanding)
+     * holds, and cancels the ones still waiting once wanted(0) does not.
+     */
+    template<typename Inputs, typename Start, typename Consume, typename Wanted>
+    void run(const Inputs &inputs, Start start, Consume consume,
+            Wanted wanted) {
+        typedef decltype(start(*inputs.begin())) Future;
+        typedef typename std::decay<decltype(std::declval<Future>().get())>::type Result;
+
+        struct Pending {
+            typename Inputs::const_iterator input;
+            Clock::time_point started;
+            Future future;
+        };
+
+        std::deque<Pending> window;
+        auto next = inputs.begin();
+        try {
+            while ((next != inputs.end() || !window.empty()) && wanted(0)) {
+                unsigned int limit = width();
+                while (next != inputs.end() && window.size() < limit
+                        && wanted(window.size())) {
+                    window.emplace_back(Pending { next, Clock::now(), start(*next) });
+                    ++next;
+                }
+
+                Pending pending = std::move(window.front());
+                window.pop_front();
+
+                if (pending.future.wait_for(std::chrono::seconds(10))
+                        != std::future_status::ready) {
+                    record(Clock::now() - pending.started, true);
+                    pending.future.cancel();
+                    throw std::domain_error("HTTP request timeout");
+                }
+
+                Result result;
+                try {
+                    result = pending.future.get();
+                } catch (...) {
+                    record(Clock::now() - pending.started, true);
+                    throw;
+                }
+                record(Clock::now() - pending.started, false);
+
+                consume(*pending.input, result);
+            }
+
+            // Enough results arrived before these did
+            for (auto &pending : window) {
+                pending.future.cancel();
+            }
+        } catch (...) {
+            // Nobody will collect these, so stop them holding connections
+            // and quota
+            for (auto &pending : window) {
+                pending.future.cancel();
+            }
+            throw;
+        }
+    }
+
+protected:
+    unsigned int width_;
+
+    unsigned int min_width_;
+
+    unsigned int max_width_;
+
+    Clock::duration target_latency_;
+
+    unsigned int successes_ = 0;
+
+    std::mutex mutex_;
+};
+
+}
+}
+
+#endif // YOUTUBE_SCOPE_FANOUT_H_
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef YOUTUBE_SCOPE_FETCH_PLAN_H_
+#define YOUTUBE_SCOPE_FETCH_PLAN_H_
+
+#include <cstddef>
+
+namespace youtube {
+namespace scope {
+
+/**
+ * Works out how much a query has to fetch to fill the number of results
+ * the shell asked for.
+ *
+ * Results come from several sources, such as the channels of a category,
+ * each expected to give a certain number of items. The plan says how many
+ * to ask each source for, whether another request is worth starting, and
+ * when to stop. A cardinality of zero means the shell wants everything.
+ */
+class FetchPlan {
+public:
+    FetchPlan(int cardinality, unsigned int per_source);
+
+    ~FetchPlan() = default;
+
+    bool unlimited() const;
+
+    /*
+     * True once enough results have been pushed
+     */
+    bool met() const;
+
+    /*
+     * The results still needed, or zero when unlimited
+     */
+    unsigned int remaining() const;
+
+    /*
+     * How many items to ask the next source for
+     */
+    unsigned int per_source() const;
+
+    /*
+     * Whether to start another request, given that many are already
+     * waiting and should each bring per_source() items
+     */
+    bool wants(std::size_t outstanding) const;
+
+    /*
+     * Counts a pushed result, returning false once no more are wanted
+     */
+    bool pushed();
+
+protected:
+    unsigned int cardinality_;
+
+    unsigned int per_source_;
+
+    unsigned int pushed_ = 0;
+};
+
+}
+}
+
+#endif // YOUTUBE_SCOPE_FETCH_PLAN_H_
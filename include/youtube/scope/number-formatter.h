@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef YOUTUBE_SCOPE_NUMBER_FORMATTER_H_
+#define YOUTUBE_SCOPE_NUMBER_FORMATTER_H_
+
+#include <locale>
+#include <string>
+
+namespace youtube {
+namespace scope {
+
+/**
+ * Formats whole numbers with the digit grouping of a locale, e.g.
+ * 1,234,567 or 1.234.567.
+ *
+ * The grouping and separator are read from the locale's numpunct facet
+ * once, so formatting a number costs no more than writing its digits.
+ */
+class NumberFormatter {
+public:
+    NumberFormatter(const std::locale &locale);
+
+    ~NumberFormatter() = default;
+
+    std::string format(long long number) const;
+
+    /*
+     * The formatter for the user's locale, built on first use
+     */
+    static const NumberFormatter & user();
+
+protected:
+    std::string grouping_;
+
+    char separator_;
+};
+
+/*
+ * Shorthand for NumberFormatter::user().format(number)
+ */
+std::string format_fixed(long long number);
+
+}
+}
+
+#endif // YOUTUBE_SCOPE_NUMBER_FORMATTER_H_
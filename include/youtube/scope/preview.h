@@ -20,6 +20,7 @@
 #define YOUTUBE_SCOPE_PREVIEW_H_
 
 #include <youtube/api/client.h>
+#include <youtube/scope/subscription-index.h>
 
 #include <unity/scopes/PreviewQueryBase.h>
 
@@ -36,7 +37,8 @@ class Preview: public unity::scopes::PreviewQueryBase {
 public:
     Preview(const unity::scopes::Result &result,
             const unity::scopes::ActionMetadata &metadata,
-            std::shared_ptr<unity::scopes::OnlineAccountClient> oa_client);
+            std::shared_ptr<unity::scopes::OnlineAccountClient> oa_client,
+            SubscriptionIndex::Ptr subscriptions = SubscriptionIndex::Ptr());
 
     ~Preview() = default;
 
@@ -52,6 +54,8 @@ protected:
     void userInfo(const unity::scopes::PreviewReplyProxy& reply);
 
     youtube::api::Client client_;
+
+    SubscriptionIndex::Ptr subscriptions_;
 };
 
 }
@@ -22,6 +22,9 @@
 #define YOUTUBE_SCOPE_QUERY_H_
 
 #include <youtube/api/client.h>
+#include <youtube/scope/chart-refresher.h>
+#include <youtube/scope/department-cache.h>
+#include <youtube/scope/result-cache.h>
 
 #include <unity/scopes/SearchQueryBase.h>
 #include <unity/scopes/ReplyProxyFwd.h>
@@ -33,7 +36,8 @@ class Query: public unity::scopes::SearchQueryBase {
 public:
     Query(const unity::scopes::CannedQuery &query,
           const unity::scopes::SearchMetadata &metadata,
-          std::shared_ptr<unity::scopes::OnlineAccountClient> oa_client);
+          std::shared_ptr<unity::scopes::OnlineAccountClient> oa_client,
+          ChartRefresher::Ptr chart_refresher = ChartRefresher::Ptr());
 
     ~Query() = default;
 
@@ -42,42 +46,46 @@ public:
     void run(const unity::scopes::SearchReplyProxy &reply) override;
 
 protected:
-    void add_login_nag(const unity::scopes::SearchReplyProxy &reply);
+    void add_login_nag(const RecordingReply::Ptr &reply);
 
-    void guide_category(const unity::scopes::SearchReplyProxy &reply,
+    void guide_category(const RecordingReply::Ptr &reply,
             const std::string &department_id);
 
-    void subscriptions(const unity::scopes::SearchReplyProxy &reply);
+    void subscriptions(const RecordingReply::Ptr &reply);
 
-    void subscription_videos(const unity::scopes::SearchReplyProxy &reply,
+    void subscription_videos(const RecordingReply::Ptr &reply,
             const std::string &department_id);
 
-    void guide_category_videos(const unity::scopes::SearchReplyProxy &reply,
+    void guide_category_videos(const RecordingReply::Ptr &reply,
             const std::string &department_id);
 
-    void guide_category_channels(const unity::scopes::SearchReplyProxy &reply,
+    void guide_category_channels(const RecordingReply::Ptr &reply,
             const std::string &department_id);
 
-    void guide_category_playlists(const unity::scopes::SearchReplyProxy &reply,
+    void guide_category_playlists(const RecordingReply::Ptr &reply,
             const std::string &department_id);
 
-    void playlist(const unity::scopes::SearchReplyProxy &reply,
+    void playlist(const RecordingReply::Ptr &reply,
             const std::string &playlist_id);
 
-    void channel(const unity::scopes::SearchReplyProxy &reply,
+    void channel(const RecordingReply::Ptr &reply,
             const std::string &channel_id);
 
-    void popular_videos(const unity::scopes::SearchReplyProxy &reply, const std::string &category_id="");
+    void popular_videos(const RecordingReply::Ptr &reply, const std::string &category_id="");
 
-    void surfacing(const unity::scopes::SearchReplyProxy &reply);
+    DepartmentCache::Tree build_departments(bool authenticated);
 
-    void search(const unity::scopes::SearchReplyProxy &reply,
+    void surfacing(const RecordingReply::Ptr &reply);
+
+    void search(const RecordingReply::Ptr &reply,
             const std::string &query_string);
 
     std::string country_code() const;
 
     youtube::api::Client client_;
 
+    ChartRefresher::Ptr chart_refresher_;
+
     std::map<std::string, std::string> my_playlist_;
 };
 
@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef YOUTUBE_SCOPE_RESULT_CACHE_H_
+#define YOUTUBE_SCOPE_RESULT_CACHE_H_
+
+#include <unity/scopes/CategorisedResult.h>
+#include <unity/scopes/Category.h>
+#include <unity/scopes/CategoryRenderer.h>
+#include <unity/scopes/Department.h>
+#include <unity/scopes/OperationInfo.h>
+#include <unity/scopes/SearchReplyProxyFwd.h>
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace youtube {
+namespace scope {
+
+/**
+ * The departments, categories and results a query sent to its reply,
+ * in order, so they can be sent again to another reply.
+ */
+class Recording {
+public:
+    typedef std::shared_ptr<const Recording> Ptr;
+
+    void register_departments(const unity::scopes::Department::SCPtr &parent);
+
+    void register_category(const std::string &id, const std::string &title,
+            const std::string &icon,
+            const unity::scopes::CategoryRenderer &renderer);
+
+    void push(const unity::scopes::CategorisedResult &result);
+
+    /*
+     * Returns false if the reply stopped accepting results
+     */
+    bool replay(const unity::scopes::SearchReplyProxy &reply) const;
+
+    std::size_t size() const;
+
+protected:
+    typedef std::map<std::string, unity::scopes::Category::SCPtr> Categories;
+
+    typedef std::function<bool(const unity::scopes::SearchReplyProxy &,
+            Categories &)> Step;
+
+    std::vector<Step> steps_;
+};
+
+/**
+ * What a query writes to. Everything is passed straight on to the
+ * client's reply, and also recorded for the result cache.
+ */
+class RecordingReply {
+public:
+    typedef std::shared_ptr<RecordingReply> Ptr;
+
+    RecordingReply(const unity::scopes::SearchReplyProxy &reply);
+
+    ~RecordingReply() = default;
+
+    void register_departments(const unity::scopes::Department::SCPtr &parent);
+
+    unity::scopes::Category::SCPtr register_category(const std::string &id,
+            const std::string &title, const std::string &icon,
+            const unity::scopes::CategoryRenderer &renderer);
+
+    bool push(const unity::scopes::CategorisedResult &result);
+
+    void info(const unity::scopes::OperationInfo &operation_info);
+
+    /*
+     * False once the client has stopped listening or been told something
+     * that only applied at the time, after which the recording is not
+     * worth replaying
+     */
+    bool complete() const;
+
+    Recording::Ptr recording() const;
+
+protected:
+    unity::scopes::SearchReplyProxy reply_;
+
+    std::shared_ptr<Recording> recording_;
+
+    bool complete_ = true;
+};
+
+/**
+ * Recordings of recent queries, keyed by everything that decides what
+ * a query shows. An identical query within the time to live is answered
+ * by replaying the recording, instead of fetching and parsing again.
+ *
+ * Shared by every query in the process. Least recently used entries are
+ * evicted once it is full.
+ */
+class ResultCache {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    ResultCache(std::size_t capacity, const Clock::duration &ttl);
+
+    ~ResultCache() = default;
+
+    static std::string key(const std::string &query_string,
+            const std::string &department_id, const std::string &region,
+            const std::string &locale, bool authenticated,
+            const std::string &account_id, int cardinality);
+
+    Recording::Ptr get(const std::string &key);
+
+    void put(const std::string &key, const Recording::Ptr &recording);
+
+    /*
+     * Forget everything, e.g. after the user changed what they would see
+     */
+    void clear();
+
+    /*
+     * The cache used by queries, sized by YOUTUBE_SCOPE_RESULT_CACHE_SIZE
+     * and YOUTUBE_SCOPE_RESULT_CACHE_TTL (seconds). A size of 0 turns it
+     * off.
+     */
+    static ResultCache & instance();
+
+protected:
+    struct Entry {
+        Recording::Ptr recording;
+
+        Clock::time_point stored;
+
+        Clock::time_point used;
+    };
+
+    std::size_t capacity_;
+
+    Clock::duration ttl_;
+
+    std::unordered_map<std::string, Entry> entries_;
+
+    std::mutex mutex_;
+};
+
+}
+}
+
+#endif // YOUTUBE_SCOPE_RESULT_CACHE_H_
@@ -29,6 +29,10 @@ namespace youtube {
 
 namespace scope {
 
+class ChartRefresher;
+
+class SubscriptionIndex;
+
 class Scope: public unity::scopes::ScopeBase {
 public:
     void start(std::string const&) override;
@@ -49,6 +53,12 @@ public:
             std::string const& action_id) override;
 protected:
     std::shared_ptr<unity::scopes::OnlineAccountClient> oa_client_;
+
+    // Keeps the charts aggregating scopes ask for in memory
+    std::shared_ptr<ChartRefresher> chart_refresher_;
+
+    // Lets previews show the subscribe state without asking the server
+    std::shared_ptr<SubscriptionIndex> subscription_index_;
 };
 
 }
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef YOUTUBE_SCOPE_SUBSCRIPTION_INDEX_H_
+#define YOUTUBE_SCOPE_SUBSCRIPTION_INDEX_H_
+
+#include <youtube/api/client.h>
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace youtube {
+namespace scope {
+
+/**
+ * The user's subscriptions by channel id, so that previews can offer
+ * Subscribe or Unsubscribe without asking the server.
+ *
+ * The index is filled from all pages of the user's subscriptions and kept
+ * current by the subscribe and unsubscribe actions. It is reconciled with
+ * the server in the background every TTL, and sooner if a lookup finds it
+ * stale. It belongs to the account that was signed in when it was loaded,
+ * and is dropped as soon as another one is.
+ */
+class SubscriptionIndex: public std::enable_shared_from_this<SubscriptionIndex> {
+public:
+    typedef std::shared_ptr<SubscriptionIndex> Ptr;
+
+    typedef std::chrono::steady_clock Clock;
+
+    SubscriptionIndex(std::shared_ptr<api::Client> client,
+            const Clock::duration &ttl);
+
+    ~SubscriptionIndex() = default;
+
+    /*
+     * Sets subscription_id to the user's subscription to the channel, or
+     * empty if there is none. Returns false while the index has not been
+     * loaded, in which case the caller has to ask the server.
+     */
+    bool lookup(const std::string &channel_id, std::string &subscription_id);
+
+    void subscribed(const std::string &channel_id,
+            const std::string &subscription_id);
+
+    void unsubscribed(const std::string &subscription_id);
+
+    /*
+     * Starts fetching the user's subscriptions on the index's client,
+     * unless that is already under way, and makes sure the next reconcile
+     * is scheduled
+     */
+    void reconcile();
+
+    /*
+     * Replaces the index with the subscriptions of the account, unless it
+     * has changed since version
+     */
+    void load(const api::Client::SubscriptionList &subscriptions,
+            unsigned long version,
+            const std::string &account_id = std::string());
+
+    unsigned long version();
+
+    void clear();
+
+    /*
+     * An index reconciled every YOUTUBE_SCOPE_SUBSCRIPTION_INDEX_TTL
+     * seconds
+     */
+    static Ptr create(std::shared_ptr<api::Client> client);
+
+protected:
+    /*
+     * Reconciles again in a TTL, unless that is already arranged. The
+     * account check can block, so it is not done on the timer thread.
+     */
+    void schedule();
+
+    /*
+     * Looks up the uploads playlists of the subscribed channels in bulk
+     */
+    void prefetch_uploads(const api::Client::SubscriptionList &subscriptions);
+
+    std::shared_ptr<api::Client> client_;
+
+    Clock::duration ttl_;
+
+    // Channel id to subscription id
+    std::unordered_map<std::string, std::string> subscriptions_;
+
+    bool loaded_ = false;
+
+    Clock::time_point loaded_at_;
+
+    // Whose subscriptions these are
+    std::string account_id_;
+
+    bool reconciling_ = false;
+
+    bool scheduled_ = false;
+
+    unsigned long version_ = 0;
+
+    std::mutex mutex_;
+};
+
+}
+}
+
+#endif // YOUTUBE_SCOPE_SUBSCRIPTION_INDEX_H_
@@ -26,6 +26,11 @@ namespace json = Json;
 using namespace youtube::api;
 using namespace std;
 
+const string & ChannelSection::fields() {
+    static const string FIELDS = "kind,id,contentDetails/playlists";
+    return FIELDS;
+}
+
 ChannelSection::ChannelSection(const json::Value &data) {
     string kind = data["kind"].asString();
 
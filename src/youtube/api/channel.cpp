@@ -27,6 +27,14 @@ namespace json = Json;
 using namespace youtube::api;
 using namespace std;
 
+const string & Channel::fields() {
+    static const string FIELDS =
+            "kind,id,snippet(title,description,thumbnails/default/url),"
+            "statistics(viewCount,subscriberCount,videoCount),"
+            "contentDetails/relatedPlaylists(likes,favorites,watchLater)";
+    return FIELDS;
+}
+
 Channel::Channel(const json::Value &data) {
 
     string kind = data["kind"].asString();
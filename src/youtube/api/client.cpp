@@ -19,7 +19,17 @@
 
 #include <youtube/api/channel.h>
 #include <youtube/api/client.h>
+#include <youtube/api/dispatcher.h>
+#include <youtube/api/environment.h>
+#include <youtube/api/metrics.h>
 #include <youtube/api/playlist.h>
+#include <youtube/api/quota.h>
+#include <youtube/api/task.h>
+#include <youtube/api/timer.h>
+#include <youtube/api/trace.h>
+#include <youtube/api/typed-list.h>
+#include <youtube/api/uploads-cache.h>
+#include <youtube/api/worker-pool.h>
 
 #include <boost/iostreams/filtering_stream.hpp>
 #include <boost/iostreams/filter/gzip.hpp>
@@ -32,7 +42,13 @@
 #include <core/net/http/response.h>
 #include <json/json.h>
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <iostream>
+#include <map>
+#include <mutex>
+#include <unordered_map>
 
 namespace http = core::net::http;
 namespace json = Json;
@@ -44,24 +60,58 @@ using namespace std;
 
 namespace {
 
-template<typename T>
-static deque<shared_ptr<T>> get_typed_list(const string &filter,
-        const json::Value &root) {
-    deque<shared_ptr<T>> results;
-    json::Value data = root["items"];
-    for (json::ArrayIndex index = 0; index < data.size(); ++index) {
-        json::Value item = data[index];
-
-        string kind = item["kind"].asString();
-        if (kind == "youtube#searchResult") {
-            kind = item["id"]["kind"].asString();
+static string endpoint_name(const net::Uri::Path &path) {
+    // Skip the "youtube", "v3" prefix, e.g. "videos/rate"
+    string name;
+    for (net::Uri::Path::size_type i = 2; i < path.size(); ++i) {
+        if (!name.empty()) {
+            name += "/";
         }
+        name += path[i];
+    }
+    return name;
+}
 
-        if (kind == filter) {
-            results.emplace_back(make_shared<T>(item));
-        }
+static unsigned int env_count(const char *name, unsigned int fallback) {
+    return max(1u, static_cast<unsigned int>(env_number(name, fallback)));
+}
+
+// The page size the API uses when maxResults is not given
+static constexpr unsigned int DEFAULT_MAX_RESULTS = 5;
+
+// The client whose response this thread is parsing, if any
+thread_local const void *parsing_here = nullptr;
+
+// How long an answer to Client::authenticated() is trusted
+static constexpr chrono::seconds ACCOUNT_CHECK_INTERVAL { 10 };
+
+// The largest page (and id batch) the API will return
+static constexpr unsigned int MAX_PAGE_SIZE = 50;
+
+/*
+ * A fields= projection of a list response down to what the model reads
+ * from each item
+ */
+static string items(const string &fields) {
+    return "items(" + fields + ")";
+}
+
+/*
+ * The API reports errors as an object with a message, older endpoints
+ * as a plain string
+ */
+static string error_message(const json::Value &root) {
+    if (!root.isObject()) {
+        return "YouTube API error";
     }
-    return results;
+    const json::Value &error = root["error"];
+    if (error.isObject() && error["message"].isString()) {
+        return error["message"].asString();
+    }
+    if (error.isString()) {
+        return error.asString();
+    }
+    return "YouTube API error";
 }
 
 template<typename T>
@@ -77,33 +127,414 @@ static T is_successful(const json::Value &root) {
 
 }
 
-class Client::Priv {
+class Client::Priv: public enable_shared_from_this<Client::Priv> {
 public:
     Priv(std::shared_ptr<unity::scopes::OnlineAccountClient> oa_client) :
-            client_(http::make_client()), worker_ { [this]() {client_->run();} },
-            oa_client_(oa_client), cancelled_(false) {
+            client_(reactors().next()), oa_client_(oa_client),
+            outstanding_(make_shared<Outstanding>()), quota_(shared_quota()),
+            dispatcher_(shared_dispatcher()), parser_(shared_parser()),
+            metrics_(shared_metrics()), priority_(Priority::surfacing) {
     }
 
     ~Priv() {
-        client_->stop();
-        if (worker_.joinable()) {
-            worker_.join();
-        }
+        // Nobody can collect the results any more
+        cancel();
+        // Continuations may still be using us from the parser pool
+        outstanding_->drain();
     }
 
     std::shared_ptr<core::net::http::Client> client_;
 
-    std::thread worker_;
-
     Config config_;
     std::mutex config_mutex_;
 
+    // The last answer to authenticated(), and when it was found
+    Config account_;
+    chrono::steady_clock::time_point account_checked_;
+
     std::shared_ptr<unity::scopes::OnlineAccountClient> oa_client_;
 
-    std::atomic<bool> cancelled_;
+    /*
+     * Cancellation handle for one outstanding request
+     */
+    struct Token {
+        std::atomic<bool> cancelled { false };
+
+        std::function<void()> fail;
+
+        Dispatcher::Ticket ticket;
+
+        std::string endpoint;
+
+        Metrics::Clock::time_point created;
+
+        Metrics::Clock::time_point started;
+
+        // How long the quota wants the request held back
+        chrono::milliseconds delay { 0 };
+
+        // Claimed by whichever comes first, sending or cancelling
+        std::atomic<bool> sent { false };
+
+        Quota::Ptr quota;
+
+        bool write = false;
+
+        // Set once the quota has been reserved for the request
+        std::atomic<bool> reserved { false };
+
+        /*
+         * Gives the quota back if the request never went out, and makes
+         * sure it never will
+         */
+        void refund() {
+            if (reserved && !sent.exchange(true)) {
+                quota->refund(endpoint, write);
+            }
+        }
+    };
+
+    /**
+     * The requests a client has in flight, and the responses it has
+     * waiting to be parsed. The event loops are shared and can outlive
+     * the client, so response handlers hold on to this rather than Priv.
+     */
+    class Outstanding: public enable_shared_from_this<Outstanding> {
+    public:
+        typedef shared_ptr<Outstanding> Ptr;
+
+        /*
+         * Registers the request so that cancel() can reach it, or returns
+         * nullptr when the client is already cancelled
+         */
+        shared_ptr<Token> track(Dispatcher::Ticket ticket,
+                const function<void()> &fail, const Quota::Ptr &quota,
+                bool write) {
+            lock_guard<mutex> lock(mutex_);
+            if (cancelled_) {
+                return nullptr;
+            }
+            auto token = make_shared<Token>();
+            token->fail = fail;
+            token->quota = quota;
+            token->write = write;
+            tokens_[ticket] = token;
+            return token;
+        }
+
+        void untrack(Dispatcher::Ticket ticket) {
+            lock_guard<mutex> lock(mutex_);
+            tokens_.erase(ticket);
+        }
+
+        /*
+         * Stops tracking the request and returns its token, or nullptr if
+         * it has already finished
+         */
+        shared_ptr<Token> withdraw(Dispatcher::Ticket ticket) {
+            lock_guard<mutex> lock(mutex_);
+            auto it = tokens_.find(ticket);
+            if (it == tokens_.end()) {
+                return nullptr;
+            }
+            auto token = it->second;
+            tokens_.erase(it);
+            return token;
+        }
+
+        void cancel() {
+            map<Dispatcher::Ticket, shared_ptr<Token>> tokens;
+            {
+                lock_guard<mutex> lock(mutex_);
+                cancelled_ = true;
+                tokens.swap(tokens_);
+            }
+            for (const auto &it : tokens) {
+                it.second->cancelled = true;
+                it.second->refund();
+                it.second->fail();
+            }
+        }
+
+        void parse(const WorkerPool::Ptr &parser, const function<void()> &job) {
+            {
+                lock_guard<mutex> lock(mutex_);
+                ++parsing_;
+            }
+            auto self = shared_from_this();
+            parser->post([self, job]() {
+                Parsing parsing(self);
+                job();
+            });
+        }
+
+        /*
+         * Wait for the responses already handed to the parser. When the
+         * last owner of the client lets go from inside one of its own
+         * continuations, that job is the caller and is not waited for.
+         */
+        void drain() {
+            unsigned int own = parsing_here == this ? 1 : 0;
+            unique_lock<mutex> lock(mutex_);
+            parsed_cond_.wait(lock, [this, own]() {
+                return parsing_ <= own;
+            });
+        }
+
+    protected:
+        /*
+         * Counts a parse job out however it ends, or drain() would wait
+         * for it forever
+         */
+        class Parsing {
+        public:
+            Parsing(const Ptr &outstanding) :
+                    outstanding_(outstanding), outer_(parsing_here) {
+                parsing_here = outstanding.get();
+            }
+
+            ~Parsing() {
+                parsing_here = outer_;
+                lock_guard<mutex> lock(outstanding_->mutex_);
+                if (--outstanding_->parsing_ == 0) {
+                    outstanding_->parsed_cond_.notify_all();
+                }
+            }
+
+        protected:
+            Ptr outstanding_;
+
+            const void *outer_;
+        };
+
+        bool cancelled_ = false;
+
+        map<Dispatcher::Ticket, shared_ptr<Token>> tokens_;
+
+        unsigned int parsing_ = 0;
+
+        mutex mutex_;
+
+        condition_variable parsed_cond_;
+    };
+
+    Outstanding::Ptr outstanding_;
+
+    Quota::Ptr quota_;
+
+    Dispatcher::Ptr dispatcher_;
+
+    WorkerPool::Ptr parser_;
+
+    Metrics::Ptr metrics_;
+
+    // Set by the query's thread, read wherever requests are issued
+    std::atomic<Priority> priority_;
+
+    /**
+     * HTTP clients shared by every client in the process, each running its
+     * event loop on its own thread. New clients are spread over them round
+     * robin, so queries no longer start a thread each.
+     */
+    class Reactors {
+    public:
+        Reactors(unsigned int count) :
+                next_(0) {
+            for (unsigned int i = 0; i < count; ++i) {
+                auto client = http::make_client();
+                clients_.emplace_back(client);
+                threads_.emplace_back([client]() {
+                    client->run();
+                });
+            }
+        }
+
+        ~Reactors() {
+            for (const auto &client : clients_) {
+                client->stop();
+            }
+            for (auto &thread : threads_) {
+                if (thread.joinable()) {
+                    thread.join();
+                }
+            }
+        }
+
+        shared_ptr<http::Client> next() {
+            return clients_[next_++ % clients_.size()];
+        }
+
+        /*
+         * net-cpp only keeps connection level timings per client, not
+         * per request
+         */
+        void dump_timings(ostream &out) {
+            typedef http::Client::Timings::Statistics Statistics;
+            auto line = [&out](const string &name, const Statistics &stats) {
+                out << "  " << name << ": mean=" << stats.mean.count() * 1000.0
+                        << "ms max=" << stats.max.count() * 1000.0 << "ms" << endl;
+            };
+            for (size_t i = 0; i < clients_.size(); ++i) {
+                auto timings = clients_[i]->timings();
+                out << "connections " << i << ":" << endl;
+                line("dns", timings.name_look_up);
+                line("connect", timings.connect);
+                line("ttfb", timings.start_transfer);
+                line("total", timings.total);
+            }
+        }
+
+    protected:
+        vector<shared_ptr<http::Client>> clients_;
+
+        vector<thread> threads_;
+
+        atomic<unsigned int> next_;
+    };
+
+    static Reactors & reactors() {
+        static Reactors reactors(env_count("YOUTUBE_SCOPE_IO_THREADS", 2));
+        return reactors;
+    }
+
+    /*
+     * Decompression, JSON parsing and model construction run here, so a
+     * large fan-out parses on every core instead of behind one event loop
+     */
+    static WorkerPool::Ptr shared_parser() {
+        static WorkerPool::Ptr parser = make_shared<WorkerPool>(
+                env_count("YOUTUBE_SCOPE_PARSE_THREADS",
+                        max(1u, thread::hardware_concurrency())));
+        return parser;
+    }
+
+    static Metrics::Ptr shared_metrics() {
+        static Metrics::Ptr metrics = make_shared<Metrics>();
+        return metrics;
+    }
+
+    /*
+     * YouTube charges the quota per API key, so every client in the
+     * process draws from the same budget
+     */
+    static Quota::Ptr shared_quota() {
+        // The API allows 3000 units per 100 seconds per user
+        static Quota::Ptr quota = make_shared<Quota>(
+                static_cast<unsigned long>(env_number(
+                        "YOUTUBE_SCOPE_QUOTA_BUDGET", 1000000)),
+                env_number("YOUTUBE_SCOPE_QUOTA_BURST", 3000.0),
+                env_number("YOUTUBE_SCOPE_QUOTA_REFILL", 30.0));
+        return quota;
+    }
+
+    /**
+     * Recent statistics of the videos that have been previewed, shared
+     * between all clients.
+     */
+    class StatisticsCache {
+    public:
+        typedef chrono::steady_clock Clock;
+
+        StatisticsCache(const Clock::duration &ttl) :
+                ttl_(ttl) {
+        }
+
+        bool get(const string &video_id, Video::Statistics &statistics) {
+            lock_guard<mutex> lock(mutex_);
+            auto it = statistics_.find(video_id);
+            if (it == statistics_.cend()) {
+                return false;
+            }
+            if (Clock::now() - it->second.second > ttl_) {
+                statistics_.erase(it);
+                return false;
+            }
+            statistics = it->second.first;
+            return true;
+        }
+
+        void put(const string &video_id, const Video::Statistics &statistics) {
+            lock_guard<mutex> lock(mutex_);
+            statistics_[video_id] = make_pair(statistics, Clock::now());
+        }
+
+        void evict(const string &video_id) {
+            lock_guard<mutex> lock(mutex_);
+            statistics_.erase(video_id);
+        }
+
+    protected:
+        Clock::duration ttl_;
+
+        unordered_map<string, pair<Video::Statistics, Clock::time_point>> statistics_;
+
+        mutex mutex_;
+    };
+
+    static StatisticsCache & statistics_cache() {
+        static StatisticsCache cache(chrono::seconds(60));
+        return cache;
+    }
+
+    /*
+     * Requests from every query in the process compete for the same
+     * connections, so they are ordered by one dispatcher
+     */
+    static Dispatcher::Ptr shared_dispatcher() {
+        static Dispatcher::Ptr dispatcher = make_shared<Dispatcher>(8,
+                // interactive, surfacing, search, background
+                Dispatcher::Limits { { 8, 6, 6, 2 } });
+        return dispatcher;
+    }
+
+    /*
+     * Returns a callback that gives the request's dispatcher slot back
+     */
+    function<void()> completion(Dispatcher::Ticket ticket) {
+        Outstanding::Ptr outstanding = outstanding_;
+        Dispatcher::Ptr dispatcher = dispatcher_;
+        return [outstanding, dispatcher, ticket]() {
+            outstanding->untrack(ticket);
+            dispatcher->done(ticket);
+        };
+    }
+
+    void dispatch(const shared_ptr<Token> &token,
+            const shared_ptr<http::Request> &request,
+            const http::Request::Handler &handler) {
+        Metrics::Ptr metrics = metrics_;
+        Dispatcher::Job job = [token, metrics, request, handler]() {
+            if (token->sent.exchange(true)) {
+                // Cancelled while queued
+                return;
+            }
+            token->started = Metrics::Clock::now();
+            metrics->record(token->endpoint, Metrics::Phase::queue,
+                    token->started - token->created);
+            request->async_execute(handler);
+        };
+
+        if (token->delay <= chrono::milliseconds::zero()) {
+            dispatcher_->submit(token->ticket, this, priority_, job);
+            return;
+        }
+
+        // Requests are often issued from continuations, which must not
+        // block, so the wait for quota happens on the timer instead
+        Dispatcher::Ptr dispatcher = dispatcher_;
+        const void *owner = this;
+        Priority priority = priority_;
+        Timer::instance().schedule(token->delay,
+                [token, dispatcher, owner, priority, job]() {
+                    if (!token->cancelled) {
+                        dispatcher->submit(token->ticket, owner, priority, job);
+                    }
+                });
+    }
 
     void get(const net::Uri::Path &path,
             const net::Uri::QueryParameters &parameters,
+            const shared_ptr<Token> &token,
             http::Request::Handler &handler) {
         std::lock_guard<std::mutex> lock(config_mutex_);
         auto configuration = net_config(path, parameters);
@@ -112,34 +543,39 @@ public:
         configuration.header.add("User-Agent", config_.user_agent + " (gzip)");
         configuration.header.add("Accept-Encoding", "gzip");
 
+        metrics_->sent(token->endpoint, configuration.uri.size());
         auto request = client_->head(configuration);
-        request->async_execute(handler);
+        dispatch(token, request, handler);
     }
 
     void post(const net::Uri::Path &path,
             const net::Uri::QueryParameters &parameters,
             const std::string &postmsg,
             const std::string &content_type,
+            const shared_ptr<Token> &token,
             http::Request::Handler &handler) {
         std::lock_guard<std::mutex> lock(config_mutex_);
         http::Request::Configuration configuration = net_config(path, parameters);
         configuration.header.add("User-Agent", config_.user_agent);
         configuration.header.add("Content-Type", content_type);
 
+        metrics_->sent(token->endpoint, configuration.uri.size() + postmsg.size());
         auto request = client_->post(configuration, postmsg, content_type);
-        request->async_execute(handler);
+        dispatch(token, request, handler);
     }
 
     void del(const net::Uri::Path &path,
             const net::Uri::QueryParameters &parameters,
+            const shared_ptr<Token> &token,
             http::Request::Handler &handler) {
         std::lock_guard<std::mutex> lock(config_mutex_);
         http::Request::Configuration configuration = net_config(path, parameters);
         configuration.header.add("User-Agent", config_.user_agent);
         configuration.header.add("X-HTTP-Method-Override", "DELETE");
 
+        metrics_->sent(token->endpoint, configuration.uri.size());
         auto request = client_->post(configuration, "", "");
-        request->async_execute(handler);
+        dispatch(token, request, handler);
     }
 
     http::Request::Configuration net_config(const net::Uri::Path &path,
@@ -162,134 +598,378 @@ public:
         return configuration;
     }
 
-    http::Request::Progress::Next progress_report(
-            const http::Request::Progress&) {
-        return cancelled_ ?
-                http::Request::Progress::Next::abort_operation :
-                http::Request::Progress::Next::continue_operation;
+    void cancel() {
+        outstanding_->cancel();
+        // The aborted transfers will not report back in time, so their
+        // slots go to the next query straight away
+        dispatcher_->abandon(this);
     }
 
+    /*
+     * Wires up cancellation, error reporting and the quota check shared by
+     * every request. Returns nullptr if the request must not be issued, in
+     * which case the outcome has already been failed.
+     */
     template<typename T>
-    future<T> async_get(const net::Uri::Path &path,
-            const net::Uri::QueryParameters &parameters,
-            const function<T(const json::Value &root)> &func) {
-        auto prom = make_shared<promise<T>>();
+    shared_ptr<Token> prepare(const net::Uri::Path &path, bool write,
+            const Task<T> &prom, Dispatcher::Ticket ticket,
+            const function<void()> &finished,
+            http::Request::Handler &handler) {
+        auto token = outstanding_->track(ticket, [prom]() {
+            prom.set_exception(make_exception_ptr(Cancelled()));
+        }, quota_, write);
+        if (!token) {
+            prom.set_exception(make_exception_ptr(Cancelled()));
+            return nullptr;
+        }
+        token->ticket = ticket;
+        token->endpoint = endpoint_name(path);
+        token->created = Metrics::Clock::now();
+
+        if (Tracer::instance().enabled()) {
+            string endpoint = token->endpoint;
+            auto created = token->created;
+            prom.finally([endpoint, ticket, created]() {
+                Tracer::instance().async(endpoint, "http", ticket, created,
+                        Tracer::Clock::now());
+            });
+        }
 
-        http::Request::Handler handler;
-        handler.on_progress(
-                bind(&Client::Priv::progress_report, this, placeholders::_1));
-        handler.on_error([prom](const net::Error& e)
+        Metrics::Ptr metrics = metrics_;
+        handler.on_progress([token](const http::Request::Progress&) {
+            return token->cancelled ?
+                    http::Request::Progress::Next::abort_operation :
+                    http::Request::Progress::Next::continue_operation;
+        });
+        handler.on_error([prom, finished, token, metrics](const net::Error& e)
         {
-            prom->set_exception(make_exception_ptr(e));
+            finished();
+            if (!token->cancelled) {
+                metrics->failed(token->endpoint);
+            }
+            prom.set_exception(make_exception_ptr(e));
         });
-        handler.on_response(
-                [prom,func](const http::Response& response)
-                {
-                    string decompressed;
-
-                    if(!response.body.empty()) {
-                        try {
-                            io::filtering_ostream os;
-                            os.push(io::gzip_decompressor());
-                            os.push(io::back_inserter(decompressed));
-                            os << response.body;
-                            boost::iostreams::close(os);
-                        } catch(io::gzip_error &e) {
-                            prom->set_exception(make_exception_ptr(e));
-                            return;
-                        }
-                    }
 
-                    json::Value root;
-                    json::Reader reader;
-                    reader.parse(decompressed, root);
+        if (!quota_->reserve(token->endpoint, write, token->delay)) {
+            metrics_->failed(token->endpoint);
+            outstanding_->untrack(ticket);
+            prom.set_exception(make_exception_ptr(domain_error("YouTube API quota exhausted")));
+            return nullptr;
+        }
+        token->reserved = true;
+        if (token->cancelled) {
+            // The client was cancelled while the quota was being reserved
+            token->refund();
+            return nullptr;
+        }
 
-                    if (response.status != http::Status::ok) {
-                        prom->set_exception(make_exception_ptr(domain_error(root["error"].asString())));
-                    } else {
-                        prom->set_value(func(root));
-                    }
-                });
+        // Cancelling the task withdraws the request, and gives its quota
+        // back if it was never sent
+        weak_ptr<Outstanding> weak_outstanding(outstanding_);
+        Dispatcher::Ptr dispatcher = dispatcher_;
+        prom.on_cancel([weak_outstanding, dispatcher, ticket]() {
+            auto outstanding = weak_outstanding.lock();
+            auto token = outstanding ? outstanding->withdraw(ticket) : nullptr;
+            if (!token) {
+                return;
+            }
+            token->cancelled = true;
+            token->refund();
+            dispatcher->cancel(ticket);
+        });
+        return token;
+    }
 
-        get(path, parameters, handler);
+    /*
+     * Settles the task from a response, on the parser pool
+     */
+    template<typename T>
+    static void deliver(const Task<T> &prom,
+            const function<T(const json::Value &root)> &func,
+            const http::Response &response, bool write,
+            const Metrics::Ptr &metrics, const string &endpoint) {
+        auto started = Metrics::Clock::now();
+        bool ok = response.status == http::Status::ok
+                || (write && (response.status == http::Status::created
+                        || response.status == http::Status::no_content));
+
+        // This runs on the parser pool, which has nowhere to report an
+        // error to, so anything thrown fails the task instead
+        try {
+            // Only reads ask for gzip
+            string decompressed;
+            if (!write && !response.body.empty()) {
+                io::filtering_ostream os;
+                os.push(io::gzip_decompressor());
+                os.push(io::back_inserter(decompressed));
+                os << response.body;
+                boost::iostreams::close(os);
+            }
+            const string &body = write ? response.body : decompressed;
+            metrics->decoded(endpoint, body.size());
+
+            json::Value root;
+            json::Reader reader;
+            reader.parse(body, root);
+
+            if (!ok) {
+                metrics->failed(endpoint);
+                prom.set_exception(make_exception_ptr(domain_error(
+                        error_message(root))));
+                return;
+            }
+
+            T value = func(root);
+            metrics->record(endpoint, Metrics::Phase::parse,
+                    Metrics::Clock::now() - started);
+            prom.set_value(value);
+        } catch (...) {
+            metrics->failed(endpoint);
+            prom.set_exception(current_exception());
+        }
+    }
 
-        return prom->get_future();
+    template<typename T>
+    http::Request::ResponseHandler respond(const Task<T> &prom,
+            const function<T(const json::Value &root)> &func,
+            const function<void()> &finished,
+            const shared_ptr<Token> &token, bool write) {
+        Outstanding::Ptr outstanding = outstanding_;
+        WorkerPool::Ptr parser = parser_;
+        Metrics::Ptr metrics = metrics_;
+        return [prom, func, finished, token, write, outstanding, parser, metrics](
+                const http::Response& response)
+        {
+            finished();
+            metrics->record(token->endpoint, Metrics::Phase::transfer,
+                    Metrics::Clock::now() - token->started);
+            metrics->received(token->endpoint, response.body.size());
+
+            // Keep the event loop free for the other transfers
+            string endpoint = token->endpoint;
+            outstanding->parse(parser, [prom, func, response, write, metrics, endpoint]() {
+                Span span("parse " + endpoint, "parse");
+                deliver(prom, func, response, write, metrics, endpoint);
+            });
+        };
     }
 
     template<typename T>
-    future<T> async_post(const net::Uri::Path &path,
+    Task<T> async_get(const net::Uri::Path &path,
+            const net::Uri::QueryParameters &parameters,
+            const function<T(const json::Value &root)> &func) {
+        Task<T> prom;
+
+        auto ticket = dispatcher_->next_ticket();
+        auto finished = completion(ticket);
+
+        http::Request::Handler handler;
+        auto token = prepare(path, false, prom, ticket, finished, handler);
+        if (!token) {
+            return prom;
+        }
+        handler.on_response(respond(prom, func, finished, token, false));
+
+        get(path, parameters, token, handler);
+
+        return prom;
+    }
+
+    template<typename T>
+    Task<T> async_post(const net::Uri::Path &path,
             const net::Uri::QueryParameters &parameters,
             const std::string &postmsg,
             const std::string &content_type,
             const function<T(const json::Value &root)> &func) {
-        auto prom = make_shared<promise<T>>();
+        Task<T> prom;
+
+        auto ticket = dispatcher_->next_ticket();
+        auto finished = completion(ticket);
 
         http::Request::Handler handler;
-        handler.on_progress(
-                bind(&Client::Priv::progress_report, this, placeholders::_1));
-        handler.on_error([prom](const net::Error& e)
-        {
-            prom->set_exception(make_exception_ptr(e));
-        });
-        handler.on_response(
-                [prom,func](const http::Response& response)
-                {
-                    json::Value root;
-                    json::Reader reader;
-                    reader.parse(response.body, root);
-
-                    if (response.status != http::Status::created &&
-                            response.status != http::Status::ok &&
-                            response.status != http::Status::no_content) {
-                        prom->set_exception(make_exception_ptr(domain_error(root["error"].asString())));
-                    } else {
-                        prom->set_value(func(root));
-                    }
-                });
+        auto token = prepare(path, true, prom, ticket, finished, handler);
+        if (!token) {
+            return prom;
+        }
+        handler.on_response(respond(prom, func, finished, token, true));
 
-        post(path, parameters, postmsg, content_type, handler);
+        post(path, parameters, postmsg, content_type, token, handler);
 
-        return prom->get_future();
+        return prom;
     }
 
     template<typename T>
-    future<T> async_del(const net::Uri::Path &path,
+    Task<T> async_del(const net::Uri::Path &path,
             const net::Uri::QueryParameters &parameters,
             const function<T(const json::Value &root)> &func) {
-        auto prom = make_shared<promise<T>>();
+        Task<T> prom;
+
+        auto ticket = dispatcher_->next_ticket();
+        auto finished = completion(ticket);
 
         http::Request::Handler handler;
-        handler.on_progress(
-                bind(&Client::Priv::progress_report, this, placeholders::_1));
-        handler.on_error([prom](const net::Error& e)
-        {
-            prom->set_exception(make_exception_ptr(e));
-        });
-        handler.on_response(
-                [prom,func](const http::Response& response)
-                {
-                    json::Value root;
-                    json::Reader reader;
-                    reader.parse(response.body, root);
-
-                    if (response.status != http::Status::created &&
-                            response.status != http::Status::ok &&
-                            response.status != http::Status::no_content) {
-                        prom->set_exception(make_exception_ptr(domain_error(root["error"].asString())));
-                    } else {
-                        prom->set_value(func(root));
+        auto token = prepare(path, true, prom, ticket, finished, handler);
+        if (!token) {
+            return prom;
+        }
+        handler.on_response(respond(prom, func, finished, token, true));
+
+        del(path, parameters, token, handler);
+
+        return prom;
+    }
+
+    Task<string> uploads_playlist(const string &channel_id) {
+        string uploads;
+        if (UploadsCache::instance().get(channel_id, uploads)) {
+            metrics_->cache_hit("channels");
+            return Task<string>::ready(uploads);
+        }
+
+        return async_get<string>( { "youtube", "v3", "channels" }, { {
+                "part", "contentDetails" }, { "id", channel_id }, { "fields",
+                "items/contentDetails/relatedPlaylists/uploads" } },
+                [channel_id](const json::Value &root) {
+                    json::Value item = root["items"][0];
+                    string uploads = item["contentDetails"]["relatedPlaylists"]["uploads"].asString();
+                    if (!uploads.empty()) {
+                        UploadsCache::instance().put(channel_id, uploads);
                     }
+                    return uploads;
                 });
+    }
 
-        del(path, parameters, handler);
+    Task<bool> uploads_batch(const vector<string> &channel_ids) {
+        return async_get<bool>( { "youtube", "v3", "channels" }, { { "part",
+                "contentDetails" }, { "id", boost::algorithm::join(channel_ids, ",") },
+                { "maxResults", to_string(MAX_PAGE_SIZE) }, { "fields",
+                "items(id,contentDetails/relatedPlaylists/uploads)" } },
+                [](const json::Value &root) {
+                    UploadsCache &cache(UploadsCache::instance());
+                    json::Value items = root["items"];
+                    for (json::ArrayIndex index = 0; index < items.size(); ++index) {
+                        json::Value item = items[index];
+                        string uploads = item["contentDetails"]["relatedPlaylists"]["uploads"].asString();
+                        if (!uploads.empty()) {
+                            cache.put(item["id"].asString(), uploads);
+                        }
+                    }
+                    return true;
+                });
+    }
 
-        return prom->get_future();
+    /*
+     * The client for a continuation, which can run after the client has
+     * gone. Throws Cancelled then, failing the continuation's task just
+     * as destroying the client fails the requests still in flight.
+     */
+    static shared_ptr<Priv> lock(const weak_ptr<Priv> &weak) {
+        shared_ptr<Priv> priv = weak.lock();
+        if (!priv) {
+            throw Cancelled();
+        }
+        return priv;
+    }
+
+    Task<SubscriptionList> subscription_pages(const string &page_token,
+            const SubscriptionList &so_far) {
+        typedef pair<SubscriptionList, string> Page;
+
+        net::Uri::QueryParameters parameters { { "part", "snippet" }, {
+                "mine", "true" }, { "maxResults", to_string(MAX_PAGE_SIZE) },
+                { "fields", "nextPageToken," + items(Subscription::fields()) } };
+        if (!page_token.empty()) {
+            parameters.emplace_back(make_pair("pageToken", page_token));
+        }
+
+        weak_ptr<Priv> weak(shared_from_this());
+        return async_get<Page>( { "youtube", "v3", "subscriptions" }, parameters,
+                [](const json::Value &root) {
+                    return Page(get_typed_list<Subscription>("youtube#subscription", root),
+                            root["nextPageToken"].asString());
+                }).then([weak, so_far](const Page &page) -> Task<SubscriptionList> {
+                    SubscriptionList subscriptions(so_far);
+                    subscriptions.insert(subscriptions.end(), page.first.begin(),
+                            page.first.end());
+                    if (page.second.empty()) {
+                        return Task<SubscriptionList>::ready(subscriptions);
+                    }
+                    return lock(weak)->subscription_pages(page.second,
+                            subscriptions);
+                });
+    }
+
+    /*
+     * The most viewed of the channel's 50 latest uploads. That is not the
+     * channel's most viewed overall: an older hit that has dropped off
+     * the first page of the uploads is left out. Paging through all the
+     * uploads would cost a request per 50 videos, ranking them with
+     * search?order=viewCount costs 100 units.
+     */
+    Task<VideoList> uploads_by_views(const string &uploads,
+            unsigned int max_results) {
+        auto ids_task = async_get<vector<string>>( { "youtube", "v3", "playlistItems" },
+                { { "part", "contentDetails" }, { "playlistId", uploads },
+                  { "maxResults", to_string(MAX_PAGE_SIZE) },
+                  { "fields", "items/contentDetails/videoId" } },
+                [](const json::Value &root) {
+                    vector<string> ids;
+                    json::Value items = root["items"];
+                    for (json::ArrayIndex index = 0; index < items.size(); ++index) {
+                        ids.emplace_back(items[index]["contentDetails"]["videoId"].asString());
+                    }
+                    return ids;
+                });
+
+        weak_ptr<Priv> weak(shared_from_this());
+        return ids_task.then(
+                [weak, max_results](const vector<string> &ids) -> Task<VideoList> {
+            if (ids.empty()) {
+                return Task<VideoList>::ready(VideoList());
+            }
+
+            return lock(weak)->async_get<VideoList>( { "youtube", "v3", "videos" },
+                    { { "part", "snippet,statistics" },
+                      { "id", boost::algorithm::join(ids, ",") },
+                      { "fields", items(Video::fields()) } },
+                    [max_results](const json::Value &root) {
+                        VideoList videos = get_typed_list<Video>("youtube#video", root);
+                        stable_sort(videos.begin(), videos.end(),
+                                [](const Video::Ptr &a, const Video::Ptr &b) {
+                                    return a->statistics().view_count > b->statistics().view_count;
+                                });
+                        if (videos.size() > max_results) {
+                            videos.resize(max_results);
+                        }
+                        return videos;
+                    });
+        });
     }
 
     bool authenticated() {
         std::lock_guard<std::mutex> lock(config_mutex_);
+        check_account();
+        return account_.authenticated;
+    }
+
+    string account_id() {
+        std::lock_guard<std::mutex> lock(config_mutex_);
+        check_account();
+        return account_.account_id;
+    }
+
+    /*
+     * Queries ask several times, but the answer rarely changes
+     */
+    void check_account() {
+        auto now = chrono::steady_clock::now();
+        if (account_checked_ != chrono::steady_clock::time_point()
+                && now - account_checked_ < ACCOUNT_CHECK_INTERVAL) {
+            return;
+        }
         update_config();
-        return config_.authenticated;
+        account_ = config_;
+        account_checked_ = now;
     }
 
     void update_config() {
@@ -321,14 +1001,20 @@ public:
                 config_.access_token = status.access_token;
                 config_.client_id = status.client_id;
                 config_.client_secret = status.client_secret;
+                config_.account_id = to_string(status.account_id);
                 break;
             }
         }
 
-        if (!config_.authenticated) {
-            std::cerr << "YouTube scope is unauthenticated" << std::endl;
-        } else {
-            std::cerr << "YouTube scope is authenticated" << std::endl;
+        // This runs for every request, so only report changes
+        static atomic<int> reported(-1);
+        int authenticated = config_.authenticated ? 1 : 0;
+        if (reported.exchange(authenticated) != authenticated) {
+            if (!config_.authenticated) {
+                std::cerr << "YouTube scope is unauthenticated" << std::endl;
+            } else {
+                std::cerr << "YouTube scope is authenticated" << std::endl;
+            }
         }
     }
 };
@@ -337,9 +1023,11 @@ Client::Client(std::shared_ptr<unity::scopes::OnlineAccountClient> oa_client) :
         p(new Priv(oa_client)) {
 }
 
-future<SearchListResponse::Ptr> Client::search(const string &query,
+Task<SearchListResponse::Ptr> Client::search(const string &query,
         unsigned int max_results, const std::string &category_id) {
-    net::Uri::QueryParameters parameters { { "part", "snippet" }, { "type", "video" }, { "q", query } };
+    net::Uri::QueryParameters parameters { { "part", "snippet" }, { "type", "video" }, { "q", query },
+            { "fields", SearchListResponse::fields() + ","
+                    + items(Video::search_fields()) } };
     if (max_results > 0)
     {
         parameters.emplace_back(make_pair("maxResults", to_string(max_results)));
@@ -355,94 +1043,158 @@ future<SearchListResponse::Ptr> Client::search(const string &query,
             });
 }
 
-future<Client::GuideCategoryList> Client::guide_categories(
+Task<Client::GuideCategoryList> Client::guide_categories(
         const string &region_code, const string &locale) {
     return p->async_get<GuideCategoryList>(
             { "youtube", "v3", "guideCategories" }, { { "part", "snippet" }, {
-                    "regionCode", region_code }, { "hl", locale } },
+                    "regionCode", region_code }, { "hl", locale }, { "fields",
+                    items(GuideCategory::fields()) } },
             [](const json::Value &root) {
                 return get_typed_list<GuideCategory>("youtube#guideCategory", root);
             });
 }
 
-future<Client::SubscriptionList> Client::subscription_channels() {
+Task<Client::SubscriptionList> Client::subscription_channels() {
     return p->async_get<SubscriptionList>( { "youtube", "v3", "subscriptions" }, { {
-            "part", "snippet" }, { "mine", "true" }, {"maxResults", "50"} },
+            "part", "snippet" }, { "mine", "true" }, {"maxResults", "50"},
+            { "fields", items(Subscription::fields()) } },
             [](const json::Value &root) {
                 return get_typed_list<Subscription>("youtube#subscription", root);
     });
 }
 
-future<Client::ChannelList> Client::auth_user_info() {
+Task<Client::SubscriptionList> Client::all_subscription_channels() {
+    return p->subscription_pages("", SubscriptionList());
+}
+
+Task<Client::ChannelList> Client::auth_user_info() {
     return p->async_get<ChannelList>( { "youtube", "v3", "channels" }, { {
-            "part", "snippet,contentDetails,statistics" }, { "mine", "true" } },
+            "part", "snippet,contentDetails,statistics" }, { "mine", "true" },
+            { "fields", items(Channel::fields()) } },
             [](const json::Value &root) {
                 return get_typed_list<Channel>("youtube#channel", root);
             });
 }
 
-future<std::string> Client::subscription_channel_uploads(std::string const &department_id) {
-    std::string id = department_id.substr(13);
-    return p->async_get<std::string>( { "youtube", "v3", "channels" }, { {
-            "part", "snippet,contentDetails" }, { "id", department_id } },
-            [](const json::Value &root) {
-                Json::Value items = root["items"];
-                Json::Value item = items[0];
-                Json::Value contentDetails = item["contentDetails"];
-                Json::Value relatedPlaylists = contentDetails["relatedPlaylists"];
-                Json::Value uploads = relatedPlaylists["uploads"];;
-                return uploads.asString();
-        });
+Task<std::string> Client::subscription_channel_uploads(std::string const &department_id) {
+    return p->uploads_playlist(department_id);
 }
 
-future<Client::SubscriptionItemList> Client::subscription_items(
+Task<Client::SubscriptionItemList> Client::subscription_items(
         const string &playlistId) {
     return p->async_get<SubscriptionItemList>( { "youtube", "v3", "playlistItems" },
-            { { "part", "snippet" }, { "playlistId", playlistId }, {"maxResults", "50"}  },
+            { { "part", "snippet" }, { "playlistId", playlistId }, {"maxResults", "50"},
+              { "fields", items(SubscriptionItem::fields()) } },
             [](const json::Value &root) {
                 return get_typed_list<SubscriptionItem>("youtube#playlistItem", root);
             });
 }
 
-future<Client::ChannelList> Client::category_channels(
+Task<Client::ChannelList> Client::category_channels(
         const string &categoryId) {
     return p->async_get<ChannelList>( { "youtube", "v3", "channels" }, { {
-            "part", "snippet,statistics" }, { "categoryId", categoryId } },
+            "part", "snippet,statistics" }, { "categoryId", categoryId },
+            { "fields", items(Channel::fields()) } },
             [](const json::Value &root) {
                 return get_typed_list<Channel>("youtube#channel", root);
             });
 }
 
-future<Client::ChannelList> Client::channels_statistics(
+Task<bool> Client::prefetch_uploads(const vector<string> &channel_ids) {
+    vector<Task<bool>> batches;
+    vector<string> batch;
+    string uploads;
+    for (const string &channel_id : channel_ids) {
+        if (UploadsCache::instance().get(channel_id, uploads)) {
+            continue;
+        }
+        batch.emplace_back(channel_id);
+        if (batch.size() == MAX_PAGE_SIZE) {
+            batches.emplace_back(p->uploads_batch(batch));
+            batch.clear();
+        }
+    }
+    if (!batch.empty()) {
+        batches.emplace_back(p->uploads_batch(batch));
+    }
+
+    if (batches.empty()) {
+        return Task<bool>::ready(true);
+    }
+
+    // Failed batches are simply looked up again when they are needed
+    Task<bool> done;
+    auto remaining = make_shared<atomic<size_t>>(batches.size());
+    for (const auto &task : batches) {
+        task.finally([done, remaining]() {
+            if (--*remaining == 0) {
+                done.set_value(true);
+            }
+        });
+    }
+    done.on_cancel([batches]() {
+        for (const auto &task : batches) {
+            task.cancel();
+        }
+    });
+    return done;
+}
+
+Task<Client::ChannelList> Client::channels_statistics(
         const string &channelId) {
     return p->async_get<ChannelList>( { "youtube", "v3", "channels" }, { {
-            "part", "statistics,snippet" }, { "id", channelId } },
+            "part", "statistics,snippet" }, { "id", channelId },
+            { "fields", items(Channel::fields()) } },
             [](const json::Value &root) {
                 return get_typed_list<Channel>("youtube#channel", root);
             });
 }
 
-future<Client::ChannelSectionList> Client::channel_sections(
+Task<Client::ChannelSectionList> Client::channel_sections(
         const string &channelId, int maxResults) {
     return p->async_get<ChannelSectionList>( { "youtube", "v3",
             "channelSections" }, { { "part", "contentDetails" }, { "channelId",
-            channelId }, { "maxResults", to_string(maxResults) } },
+            channelId }, { "maxResults", to_string(maxResults) }, { "fields",
+            items(ChannelSection::fields()) } },
             [](const json::Value &root) {
                 return get_typed_list<ChannelSection>("youtube#channelSection", root);
             });
 }
 
-future<Client::VideoList> Client::channel_videos(const string &channelId) {
-    return p->async_get<VideoList>( { "youtube", "v3", "search" }, { { "part",
-            "snippet" }, { "type", "video" }, { "order", "viewCount" }, {
-            "channelId", channelId } }, [](const json::Value &root) {
-        return get_typed_list<Video>("youtube#video", root);
-    });
+Task<Client::VideoList> Client::channel_videos(const string &channelId,
+        unsigned int max_results, bool by_views) {
+    if (max_results == 0) {
+        max_results = DEFAULT_MAX_RESULTS;
+    }
+
+    // Listing the uploads playlist costs a few quota units where
+    // search?channelId= costs 100
+    weak_ptr<Priv> weak(p);
+    return p->uploads_playlist(channelId).then(
+            [weak, max_results, by_views](const string &uploads) -> Task<VideoList> {
+                if (uploads.empty()) {
+                    return Task<VideoList>::ready(VideoList());
+                }
+
+                auto priv = Priv::lock(weak);
+                if (by_views) {
+                    return priv->uploads_by_views(uploads, max_results);
+                }
+
+                return priv->async_get<VideoList>( { "youtube", "v3", "playlistItems" },
+                        { { "part", "snippet" }, { "playlistId", uploads },
+                          { "maxResults", to_string(max_results) },
+                          { "fields", items(Video::upload_fields()) } },
+                        [](const json::Value &root) {
+                            return get_typed_list<Video>("youtube#playlistItem", root);
+                        });
+            });
 }
 
-future<Client::VideoList> Client::chart_videos(const string &chart_name,
+Task<Client::VideoList> Client::chart_videos(const string &chart_name,
         const string &region_code, const std::string &category_id) {
-    net::Uri::QueryParameters params = { { "part", "snippet" }, { "regionCode", region_code }, { "chart", chart_name } };
+    net::Uri::QueryParameters params = { { "part", "snippet" }, { "regionCode", region_code }, { "chart", chart_name },
+            { "fields", items(Video::fields()) } };
 
     if (!category_id.empty()) {
         params.emplace_back(make_pair("videoCategoryId", category_id));
@@ -453,42 +1205,66 @@ future<Client::VideoList> Client::chart_videos(const string &chart_name,
             });
 }
 
-future<Client::VideoList> Client::videos(const string &video_id) {
+Task<Client::VideoList> Client::videos(const string &video_id) {
     return p->async_get<VideoList>( { "youtube", "v3", "videos" }, { { "part",
-            "snippet,statistics" }, { "id", video_id } },
+            "snippet,statistics" }, { "id", video_id }, { "fields",
+            items(Video::fields()) } },
             [](const json::Value &root) {
                 return get_typed_list<Video>("youtube#video", root);
             });
 }
 
-future<Client::PlaylistList> Client::channel_playlists(
+Task<Video::Statistics> Client::video_statistics(const string &video_id) {
+    Video::Statistics statistics;
+    if (Priv::statistics_cache().get(video_id, statistics)) {
+        p->metrics_->cache_hit("videos");
+        return Task<Video::Statistics>::ready(statistics);
+    }
+
+    return p->async_get<Video::Statistics>( { "youtube", "v3", "videos" }, { {
+            "part", "statistics" }, { "id", video_id }, { "fields",
+            items(Video::statistics_fields()) } },
+            [video_id](const json::Value &root) {
+                VideoList videos = get_typed_list<Video>("youtube#video", root);
+                if (videos.empty() || !videos.front()->has_statistics()) {
+                    throw domain_error("No statistics for video " + video_id);
+                }
+                Priv::statistics_cache().put(video_id, videos.front()->statistics());
+                return videos.front()->statistics();
+            });
+}
+
+Task<Client::PlaylistList> Client::channel_playlists(
         const string &channelId) {
     return p->async_get<PlaylistList>( { "youtube", "v3", "playlists" }, { {
-            "part", "snippet,contentDetails" }, { "channelId", channelId } },
+            "part", "snippet,contentDetails" }, { "channelId", channelId },
+            { "fields", items(Playlist::fields()) } },
             [](const json::Value &root) {
                 return get_typed_list<Playlist>("youtube#playlist", root);
             });
 }
 
-future<Client::PlaylistItemList> Client::playlist_items(
+Task<Client::PlaylistItemList> Client::playlist_items(
         const string &playlistId) {
     return p->async_get<PlaylistItemList>( { "youtube", "v3", "playlistItems" },
-            { { "part", "snippet,contentDetails" }, { "playlistId", playlistId } },
+            { { "part", "snippet,contentDetails" }, { "playlistId", playlistId },
+              { "fields", items(PlaylistItem::fields()) } },
             [](const json::Value &root) {
                 return get_typed_list<PlaylistItem>("youtube#playlistItem", root);
             });
 }
 
-future<Client::CommentList> Client::video_comments(const std::string &videoId) {
+Task<Client::CommentList> Client::video_comments(const std::string &videoId) {
     return p->async_get<CommentList>( { "youtube", "v3", "commentThreads" },
             { { "part", "snippet" }, {"order", "time"}, { "videoId", videoId },
-              { "textFormat", "plainText"}, {"maxResults","15"}},
+              { "textFormat", "plainText"}, {"maxResults","15"},
+              { "fields", items(Comment::fields()) } },
             [](const json::Value &root) {
                 return get_typed_list<Comment>("youtube#commentThread", root);
     });
 }
 
-future<bool> Client::post_comments(const string &videoId, const string postmsg) {
+Task<bool> Client::post_comments(const string &videoId, const string postmsg) {
     Json::Value comThreadRoot;
     comThreadRoot["snippet"]["topLevelComment"]["snippet"]["textOriginal"] = postmsg;
     comThreadRoot["snippet"]["topLevelComment"]["snippet"]["videoId"] = videoId;
@@ -505,23 +1281,29 @@ future<bool> Client::post_comments(const string &videoId, const string postmsg)
             });
 }
 
-future<bool> Client::rate(const string &videoId, bool likes) {
+Task<bool> Client::rate(const string &videoId, bool likes) {
     return p->async_post<bool>( { "youtube", "v3", "videos", "rate" },
             { { "id", videoId }, { "rating", likes ? "like":"dislike"} }, "", "",
-            [](const json::Value &root) {
-                return is_successful<bool>(root);
+            [videoId](const json::Value &root) {
+                bool rated = is_successful<bool>(root);
+                if (rated) {
+                    // The next preview shows the new count
+                    Priv::statistics_cache().evict(videoId);
+                }
+                return rated;
     });
 }
 
-future<Client::SubscriptionList> Client::subscribeId(const string &channelId) {
+Task<Client::SubscriptionList> Client::subscribeId(const string &channelId) {
     return p->async_get<SubscriptionList>( { "youtube", "v3", "subscriptions" }, { {
-            "part", "snippet" }, { "mine", "true" }, {"forChannelId", channelId} },
+            "part", "snippet" }, { "mine", "true" }, {"forChannelId", channelId},
+            { "fields", items(Subscription::fields()) } },
             [](const json::Value &root) {
                 return get_typed_list<Subscription>("youtube#subscription", root);
             });
 }
 
-future<bool> Client::subscribe(const string &channelId) {
+Task<string> Client::subscribe(const string &channelId) {
     Json::Value channelRoot;
     channelRoot["snippet"]["resourceId"]["channelId"] = channelId;
     channelRoot["snippet"]["resourceId"]["kind"] = "youtube#channel";
@@ -530,14 +1312,14 @@ future<bool> Client::subscribe(const string &channelId) {
     std::string postbody = writer.write( channelRoot );
     std::string content_type = "application/json";
 
-    return p->async_post<bool>({ "youtube", "v3", "subscriptions" },
+    return p->async_post<string>({ "youtube", "v3", "subscriptions" },
             { { "part", "snippet" }}, postbody, content_type,
             [](const json::Value &root) {
-                return is_successful<bool>(root);
+                return root["id"].asString();
             });
 }
 
-future<bool> Client::unSubscribe(const string &subscribeId) {
+Task<bool> Client::unSubscribe(const string &subscribeId) {
     return p->async_del<bool>({ "youtube", "v3", "subscriptions" },
             { { "id", subscribeId }},
             [](const json::Value &root) {
@@ -545,7 +1327,7 @@ future<bool> Client::unSubscribe(const string &subscribeId) {
     });
 }
 
-future<bool> Client::addVideoIntoPlayList(const string &videoId,
+Task<bool> Client::addVideoIntoPlayList(const string &videoId,
                                           const string &playlistId) {
     Json::Value channelRoot;
     channelRoot["snippet"]["playlistId"] = playlistId;
@@ -563,9 +1345,34 @@ future<bool> Client::addVideoIntoPlayList(const string &videoId,
             });
 }
 void Client::cancel() {
-    p->cancelled_ = true;
+    p->cancel();
 }
 
 bool Client::authenticated() {
     return p->authenticated();
 }
+
+string Client::account_id() {
+    return p->account_id();
+}
+
+void Client::set_priority(Priority priority) {
+    p->priority_ = priority;
+}
+
+bool Client::quota_low() {
+    return p->quota_->low();
+}
+
+WorkerPool::Stats Client::parse_stats() {
+    return p->parser_->stats();
+}
+
+Metrics::Snapshot Client::metrics() {
+    return p->metrics_->snapshot();
+}
+
+void Client::dump_metrics(std::ostream &out) {
+    p->metrics_->dump(out);
+    Priv::reactors().dump_timings(out);
+}
@@ -25,6 +25,13 @@ namespace json = Json;
 using namespace youtube::api;
 using namespace std;
 
+const string & Comment::fields() {
+    static const string FIELDS =
+            "kind,id,snippet/topLevelComment(publishedAt,snippet(textDisplay,"
+            + User::fields() + "))";
+    return FIELDS;
+}
+
 Comment::Comment(const json::Value &data) :
         user_(data["snippet"]["topLevelComment"]["snippet"]) {
     body_ = data["snippet"]["topLevelComment"]["snippet"]["textDisplay"].asString();
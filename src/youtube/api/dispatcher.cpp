@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <youtube/api/dispatcher.h>
+
+#include <algorithm>
+
+using namespace youtube::api;
+using namespace std;
+
+constexpr size_t Dispatcher::PRIORITY_COUNT;
+
+Dispatcher::Dispatcher(unsigned int max_active, const Limits &limits) :
+        max_active_(max_active), limits_(limits) {
+    active_.fill(0);
+}
+
+Dispatcher::Ticket Dispatcher::next_ticket() {
+    lock_guard<mutex> lock(mutex_);
+    return ++next_ticket_;
+}
+
+void Dispatcher::submit(Ticket ticket, const void *owner, Priority priority,
+        const Job &job) {
+    deque<Job> runnable;
+    {
+        lock_guard<mutex> lock(mutex_);
+        queues_[static_cast<size_t>(priority)].emplace_back(
+                Entry { ticket, owner, job });
+        take_runnable(runnable);
+    }
+    run(runnable);
+}
+
+void Dispatcher::done(Ticket ticket) {
+    deque<Job> runnable;
+    {
+        lock_guard<mutex> lock(mutex_);
+        auto it = running_.find(ticket);
+        if (it == running_.end()) {
+            return;
+        }
+        release(it);
+        take_runnable(runnable);
+    }
+    run(runnable);
+}
+
+void Dispatcher::abandon(const void *owner) {
+    deque<Job> runnable;
+    {
+        lock_guard<mutex> lock(mutex_);
+        for (auto &queue : queues_) {
+            queue.erase(remove_if(queue.begin(), queue.end(),
+                    [owner](const Entry &entry) {
+                        return entry.owner == owner;
+                    }), queue.end());
+        }
+        for (auto it = running_.begin(); it != running_.end();) {
+            if (it->second.owner == owner) {
+                release(it++);
+            } else {
+                ++it;
+            }
+        }
+        take_runnable(runnable);
+    }
+    run(runnable);
+}
+
+void Dispatcher::cancel(Ticket ticket) {
+    deque<Job> runnable;
+    {
+        lock_guard<mutex> lock(mutex_);
+        for (auto &queue : queues_) {
+            queue.erase(remove_if(queue.begin(), queue.end(),
+                    [ticket](const Entry &entry) {
+                        return entry.ticket == ticket;
+                    }), queue.end());
+        }
+        auto it = running_.find(ticket);
+        if (it != running_.end()) {
+            release(it);
+        }
+        take_runnable(runnable);
+    }
+    run(runnable);
+}
+
+size_t Dispatcher::queued(Priority priority) {
+    lock_guard<mutex> lock(mutex_);
+    return queues_[static_cast<size_t>(priority)].size();
+}
+
+unsigned int Dispatcher::active(Priority priority) {
+    lock_guard<mutex> lock(mutex_);
+    return active_[static_cast<size_t>(priority)];
+}
+
+void Dispatcher::release(map<Ticket, Running>::iterator it) {
+    --active_[static_cast<size_t>(it->second.priority)];
+    running_.erase(it);
+}
+
+void Dispatcher::take_runnable(deque<Job> &runnable) {
+    // Classes are scanned from most to least urgent, so queued interactive
+    // work always gets the next free slot
+    for (size_t p = 0; p < PRIORITY_COUNT && running_.size() < max_active_; ++p) {
+        auto &queue = queues_[p];
+        while (!queue.empty() && active_[p] < limits_[p]
+                && running_.size() < max_active_) {
+            Entry &entry = queue.front();
+            running_[entry.ticket] = Running { entry.owner,
+                    static_cast<Priority>(p) };
+            ++active_[p];
+            runnable.emplace_back(entry.job);
+            queue.pop_front();
+        }
+    }
+}
+
+void Dispatcher::run(deque<Job> &runnable) {
+    for (const Job &job : runnable) {
+        job();
+    }
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <youtube/api/environment.h>
+
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+
+using namespace std;
+
+namespace {
+
+/*
+ * Parses the whole of value, or returns false
+ */
+static bool parse(const char *value, double &number) {
+    char *end = nullptr;
+    errno = 0;
+    number = strtod(value, &end);
+    return end != value && *end == '\0' && errno == 0 && isfinite(number);
+}
+
+}
+
+namespace youtube {
+namespace api {
+
+double env_number(const char *name, double fallback) {
+    const char *value = getenv(name);
+    if (!value) {
+        return fallback;
+    }
+    double number;
+    if (parse(value, number) && number > 0) {
+        return number;
+    }
+    cerr << "Ignoring " << name << "=" << value << endl;
+    return fallback;
+}
+
+unsigned long env_whole(const char *name, unsigned long fallback) {
+    const char *value = getenv(name);
+    if (!value) {
+        return fallback;
+    }
+    double number;
+    if (parse(value, number) && number >= 0 && number == floor(number)
+            && number <= numeric_limits<unsigned long>::max()) {
+        return static_cast<unsigned long>(number);
+    }
+    cerr << "Ignoring " << name << "=" << value << endl;
+    return fallback;
+}
+
+}
+}
@@ -26,6 +26,11 @@ namespace json = Json;
 using namespace youtube::api;
 using namespace std;
 
+const std::string & GuideCategory::fields() {
+    static const string FIELDS = "kind,id,snippet/title";
+    return FIELDS;
+}
+
 GuideCategory::GuideCategory(const json::Value &data) {
     id_ = data["id"].asString();
 
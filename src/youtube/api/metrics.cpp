@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <youtube/api/metrics.h>
+
+#include <algorithm>
+
+using namespace youtube::api;
+using namespace std;
+
+namespace {
+
+typedef chrono::microseconds Micros;
+
+static const char * const PHASE_NAMES[] = { "queue", "transfer", "parse" };
+
+static double millis(const Histogram::Clock::duration &value) {
+    return chrono::duration<double, milli>(value).count();
+}
+
+}
+
+constexpr unsigned int Histogram::SUB_BUCKETS;
+constexpr unsigned int Histogram::BUCKET_COUNT;
+constexpr size_t Metrics::PHASE_COUNT;
+
+Histogram::Histogram() {
+    buckets_.fill(0);
+}
+
+unsigned int Histogram::index(unsigned long long micros) {
+    if (micros < SUB_BUCKETS) {
+        return micros;
+    }
+    // Position of the highest set bit, at least 4 here
+    unsigned int magnitude = 63 - __builtin_clzll(micros);
+    unsigned int sub_bucket = (micros >> (magnitude - 4)) & (SUB_BUCKETS - 1);
+    return min(BUCKET_COUNT - 1, (magnitude - 3) * SUB_BUCKETS + sub_bucket);
+}
+
+unsigned long long Histogram::lowest(unsigned int index) {
+    if (index < SUB_BUCKETS) {
+        return index;
+    }
+    unsigned int magnitude = index / SUB_BUCKETS + 3;
+    unsigned long long sub_bucket = index % SUB_BUCKETS;
+    return (SUB_BUCKETS + sub_bucket) << (magnitude - 4);
+}
+
+void Histogram::record(const Clock::duration &value) {
+    unsigned long long micros = std::max(0ll,
+            static_cast<long long>(chrono::duration_cast<Micros>(value).count()));
+    ++buckets_[index(micros)];
+    ++count_;
+    total_ += micros;
+    max_ = std::max(max_, micros);
+}
+
+unsigned long Histogram::count() const {
+    return count_;
+}
+
+Histogram::Clock::duration Histogram::mean() const {
+    if (count_ == 0) {
+        return Clock::duration::zero();
+    }
+    return Micros(total_ / count_);
+}
+
+Histogram::Clock::duration Histogram::max() const {
+    return Micros(max_);
+}
+
+Histogram::Clock::duration Histogram::percentile(double fraction) const {
+    unsigned long wanted = static_cast<unsigned long>(fraction * count_ + 0.5);
+    unsigned long seen = 0;
+    for (unsigned int i = 0; i < BUCKET_COUNT; ++i) {
+        seen += buckets_[i];
+        if (seen >= std::max(1ul, wanted)) {
+            return Micros(std::min(lowest(i), max_));
+        }
+    }
+    return Micros(max_);
+}
+
+void Metrics::sent(const string &endpoint, size_t bytes) {
+    lock_guard<mutex> lock(mutex_);
+    Endpoint &e = endpoints_[endpoint];
+    ++e.requests;
+    e.bytes_out += bytes;
+}
+
+void Metrics::received(const string &endpoint, size_t bytes) {
+    lock_guard<mutex> lock(mutex_);
+    endpoints_[endpoint].bytes_in += bytes;
+}
+
+void Metrics::decoded(const string &endpoint, size_t bytes) {
+    lock_guard<mutex> lock(mutex_);
+    endpoints_[endpoint].bytes_decoded += bytes;
+}
+
+void Metrics::failed(const string &endpoint) {
+    lock_guard<mutex> lock(mutex_);
+    ++endpoints_[endpoint].errors;
+}
+
+void Metrics::cache_hit(const string &endpoint) {
+    lock_guard<mutex> lock(mutex_);
+    ++endpoints_[endpoint].cache_hits;
+}
+
+void Metrics::record(const string &endpoint, Phase phase,
+        const Clock::duration &latency) {
+    lock_guard<mutex> lock(mutex_);
+    endpoints_[endpoint].latency[static_cast<size_t>(phase)].record(latency);
+}
+
+Metrics::Snapshot Metrics::snapshot() {
+    lock_guard<mutex> lock(mutex_);
+    return endpoints_;
+}
+
+void Metrics::dump(ostream &out) {
+    for (const auto &it : snapshot()) {
+        const Endpoint &e = it.second;
+        out << it.first << ": requests=" << e.requests << " errors="
+                << e.errors << " cache_hits=" << e.cache_hits << " bytes_out="
+                << e.bytes_out << " bytes_in=" << e.bytes_in
+                << " bytes_decoded=" << e.bytes_decoded << endl;
+
+        for (size_t p = 0; p < PHASE_COUNT; ++p) {
+            const Histogram &h = e.latency[p];
+            if (h.count() == 0) {
+                continue;
+            }
+            out << "  " << PHASE_NAMES[p] << ": count=" << h.count()
+                    << " mean=" << millis(h.mean()) << "ms p50="
+                    << millis(h.percentile(0.5)) << "ms p90="
+                    << millis(h.percentile(0.9)) << "ms p99="
+                    << millis(h.percentile(0.99)) << "ms max="
+                    << millis(h.max()) << "ms" << endl;
+        }
+    }
+}
@@ -24,6 +24,13 @@ namespace json = Json;
 using namespace youtube::api;
 using namespace std;
 
+const string & PlaylistItem::fields() {
+    static const string FIELDS =
+            "kind,id,snippet(title,description,channelTitle,thumbnails/high/url),"
+            "contentDetails/videoId";
+    return FIELDS;
+}
+
 PlaylistItem::PlaylistItem(const json::Value &data) {
     string kind = data["kind"].asString();
 
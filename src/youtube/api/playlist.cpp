@@ -26,6 +26,13 @@ namespace json = Json;
 using namespace youtube::api;
 using namespace std;
 
+const std::string & Playlist::fields() {
+    static const string FIELDS =
+            "kind,id,snippet(title,description,thumbnails/default/url),"
+            "contentDetails/itemCount";
+    return FIELDS;
+}
+
 Playlist::Playlist(const json::Value &data) {
     string kind = data["kind"].asString();
 
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <youtube/api/quota.h>
+
+#include <algorithm>
+#include <unordered_map>
+
+using namespace youtube::api;
+using namespace std;
+
+namespace {
+// Costs taken from https://developers.google.com/youtube/v3/determine_quota_cost
+static const unordered_map<string, unsigned int> READ_COSTS = {
+        { "search", 100 }
+};
+
+static constexpr unsigned int DEFAULT_READ_COST = 1;
+
+static constexpr unsigned int WRITE_COST = 50;
+
+static constexpr chrono::milliseconds MAX_DELAY { 5000 };
+
+// Below these fractions of the bucket / daily budget we consider the quota low
+static constexpr double LOW_BUCKET = 0.25;
+static constexpr double LOW_BUDGET = 0.1;
+}
+
+Quota::Quota(unsigned long daily_budget, double bucket_capacity,
+        double refill_per_second) :
+        daily_budget_(daily_budget), capacity_(bucket_capacity), rate_(
+                refill_per_second), tokens_(bucket_capacity), last_refill_(
+                Clock::now()), day_start_(last_refill_) {
+}
+
+unsigned int Quota::cost(const string &endpoint, bool write) {
+    if (write) {
+        return WRITE_COST;
+    }
+    auto it = READ_COSTS.find(endpoint);
+    return it == READ_COSTS.cend() ? DEFAULT_READ_COST : it->second;
+}
+
+void Quota::refill(const Clock::time_point &now) {
+    if (now - day_start_ >= chrono::hours(24)) {
+        day_start_ = now;
+        spent_ = 0;
+    }
+
+    chrono::duration<double> elapsed = now - last_refill_;
+    tokens_ = min(capacity_, tokens_ + elapsed.count() * rate_);
+    last_refill_ = now;
+}
+
+bool Quota::reserve(const string &endpoint, bool write,
+        chrono::milliseconds &delay) {
+    unsigned int units = cost(endpoint, write);
+
+    lock_guard<mutex> lock(mutex_);
+    refill(Clock::now());
+
+    if (spent_ + units > daily_budget_) {
+        return false;
+    }
+
+    // Tokens may go negative; the debt is what the caller has to wait out.
+    // This keeps requests that arrive together in their arrival order.
+    double debt = units - tokens_;
+    delay = chrono::milliseconds::zero();
+    if (debt > 0) {
+        delay = chrono::milliseconds(
+                static_cast<long long>(1000.0 * debt / rate_));
+        if (delay > MAX_DELAY) {
+            return false;
+        }
+    }
+
+    tokens_ -= units;
+    spent_ += units;
+
+    Usage &u = usage_[endpoint];
+    ++u.requests;
+    u.units += units;
+
+    return true;
+}
+
+void Quota::refund(const string &endpoint, bool write) {
+    unsigned int units = cost(endpoint, write);
+
+    lock_guard<mutex> lock(mutex_);
+    refill(Clock::now());
+
+    tokens_ = min(capacity_, tokens_ + units);
+    spent_ -= min<unsigned long>(spent_, units);
+
+    Usage &u = usage_[endpoint];
+    u.requests -= min<unsigned long>(u.requests, 1);
+    u.units -= min<unsigned long>(u.units, units);
+}
+
+bool Quota::low() {
+    lock_guard<mutex> lock(mutex_);
+    refill(Clock::now());
+    return tokens_ < capacity_ * LOW_BUCKET
+            || daily_budget_ - spent_ < daily_budget_ * LOW_BUDGET;
+}
+
+unsigned long Quota::remaining() {
+    lock_guard<mutex> lock(mutex_);
+    refill(Clock::now());
+    return daily_budget_ - spent_;
+}
+
+Quota::UsageMap Quota::usage() {
+    lock_guard<mutex> lock(mutex_);
+    return usage_;
+}
@@ -42,6 +42,11 @@ static unordered_map<string, function<Resource::Ptr(const json::Value &)>> TYPES
         } } };
 }
 
+const string & SearchListResponse::fields() {
+    static const string FIELDS = "pageInfo/totalResults";
+    return FIELDS;
+}
+
 SearchListResponse::SearchListResponse(const json::Value &data) {
     json::Value page_info = data["pageInfo"];
 
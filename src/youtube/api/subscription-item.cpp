@@ -26,6 +26,13 @@ namespace json = Json;
 using namespace youtube::api;
 using namespace std;
 
+const std::string & SubscriptionItem::fields() {
+    static const string FIELDS =
+            "kind,id,snippet(title,description,channelTitle,thumbnails/high/url,"
+            "resourceId/videoId)";
+    return FIELDS;
+}
+
 SubscriptionItem::SubscriptionItem(const json::Value &data) {
     string kind = data["kind"].asString();
 
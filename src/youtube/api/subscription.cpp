@@ -27,6 +27,12 @@ namespace json = Json;
 using namespace youtube::api;
 using namespace std;
 
+const string & Subscription::fields() {
+    static const string FIELDS =
+            "kind,id,snippet(title,resourceId/channelId,thumbnails/default/url)";
+    return FIELDS;
+}
+
 Subscription::Subscription(const json::Value &data) {
 
     id_ = data["id"].asString();
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <youtube/api/timer.h>
+
+using namespace youtube::api;
+using namespace std;
+
+Timer::Timer() :
+        thread_([this]() {
+            work();
+        }) {
+}
+
+Timer::~Timer() {
+    {
+        lock_guard<mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    jobs_cond_.notify_all();
+
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void Timer::schedule(const Clock::duration &delay, const Job &job) {
+    {
+        lock_guard<mutex> lock(mutex_);
+        jobs_.emplace(Clock::now() + delay, job);
+    }
+    jobs_cond_.notify_one();
+}
+
+size_t Timer::pending() {
+    lock_guard<mutex> lock(mutex_);
+    return jobs_.size();
+}
+
+Timer & Timer::instance() {
+    static Timer timer;
+    return timer;
+}
+
+void Timer::work() {
+    unique_lock<mutex> lock(mutex_);
+    while (!stopping_) {
+        if (jobs_.empty()) {
+            jobs_cond_.wait(lock);
+            continue;
+        }
+
+        auto due = jobs_.begin()->first;
+        if (Clock::now() < due) {
+            jobs_cond_.wait_until(lock, due);
+            continue;
+        }
+
+        Job job = move(jobs_.begin()->second);
+        jobs_.erase(jobs_.begin());
+
+        lock.unlock();
+        job();
+        lock.lock();
+    }
+}
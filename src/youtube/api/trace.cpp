@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <youtube/api/trace.h>
+
+#include <json/json.h>
+
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <thread>
+#include <unistd.h>
+
+namespace json = Json;
+
+using namespace youtube::api;
+using namespace std;
+
+namespace {
+
+// Stop collecting rather than grow without bound in a long session
+static constexpr size_t MAX_EVENTS = 200000;
+
+}
+
+Tracer & Tracer::instance() {
+    static Tracer tracer(
+            getenv("YOUTUBE_SCOPE_TRACE") ? getenv("YOUTUBE_SCOPE_TRACE") : "");
+    return tracer;
+}
+
+Tracer::Tracer(const string &path) :
+        path_(path), epoch_(Clock::now()) {
+}
+
+Tracer::~Tracer() {
+    flush();
+}
+
+bool Tracer::enabled() const {
+    return !path_.empty();
+}
+
+void Tracer::complete(const string &name, const string &category,
+        const Clock::time_point &start, const Clock::time_point &end) {
+    if (!enabled()) {
+        return;
+    }
+    add(Event { name, category, 'X', 0, micros(start), micros(end) - micros(start),
+            hash<thread::id>()(this_thread::get_id()) });
+}
+
+void Tracer::async(const string &name, const string &category,
+        unsigned long id, const Clock::time_point &start,
+        const Clock::time_point &end) {
+    if (!enabled()) {
+        return;
+    }
+    size_t tid = hash<thread::id>()(this_thread::get_id());
+    add(Event { name, category, 'b', id, micros(start), 0, tid });
+    add(Event { name, category, 'e', id, micros(end), 0, tid });
+}
+
+void Tracer::flush() {
+    if (!enabled()) {
+        return;
+    }
+
+    json::Value events(json::arrayValue);
+    {
+        lock_guard<mutex> lock(mutex_);
+        for (const Event &event : events_) {
+            json::Value e;
+            e["name"] = event.name;
+            e["cat"] = event.category;
+            e["ph"] = string(1, event.phase);
+            e["ts"] = json::Value::Int64(event.timestamp);
+            e["pid"] = getpid();
+            // Thread ids only need to be distinct, keep them small
+            e["tid"] = json::Value::UInt(event.thread % 100000);
+            if (event.phase == 'X') {
+                e["dur"] = json::Value::Int64(event.duration);
+            } else {
+                e["id"] = json::Value::UInt64(event.id);
+            }
+            events.append(e);
+        }
+    }
+
+    json::Value root;
+    root["traceEvents"] = events;
+    root["displayTimeUnit"] = "ms";
+
+    ofstream out(path_);
+    if (!out) {
+        cerr << "Could not write trace to " << path_ << endl;
+        return;
+    }
+    json::FastWriter writer;
+    out << writer.write(root);
+}
+
+void Tracer::add(const Event &event) {
+    lock_guard<mutex> lock(mutex_);
+    if (events_.size() < MAX_EVENTS) {
+        events_.emplace_back(event);
+    }
+}
+
+long long Tracer::micros(const Clock::time_point &time) const {
+    return chrono::duration_cast<chrono::microseconds>(time - epoch_).count();
+}
+
+Span::Span(const string &name, const string &category) :
+        name_(name), category_(category), start_(Tracer::Clock::now()) {
+}
+
+Span::~Span() {
+    Tracer::instance().complete(name_, category_, start_, Tracer::Clock::now());
+}
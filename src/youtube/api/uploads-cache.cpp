@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <youtube/api/uploads-cache.h>
+
+#include <youtube/api/environment.h>
+
+#include <json/json.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+namespace json = Json;
+using namespace youtube::api;
+using namespace std;
+
+constexpr size_t UploadsCache::DEFAULT_CAPACITY;
+
+UploadsCache::UploadsCache(size_t capacity) :
+        capacity_(capacity) {
+}
+
+bool UploadsCache::get(const string &channel_id, string &uploads) {
+    lock_guard<mutex> lock(mutex_);
+    auto it = index_.find(channel_id);
+    if (it == index_.cend()) {
+        return false;
+    }
+    entries_.splice(entries_.begin(), entries_, it->second);
+    uploads = it->second->second;
+    return true;
+}
+
+void UploadsCache::put(const string &channel_id, const string &uploads) {
+    lock_guard<mutex> lock(mutex_);
+    auto it = index_.find(channel_id);
+    if (it == index_.end()) {
+        insert(channel_id, uploads, true);
+    } else {
+        entries_.splice(entries_.begin(), entries_, it->second);
+        if (it->second->second == uploads) {
+            return;
+        }
+        it->second->second = uploads;
+    }
+    dirty_ = true;
+}
+
+void UploadsCache::insert(const string &channel_id, const string &uploads,
+        bool fresh) {
+    if (capacity_ == 0) {
+        return;
+    }
+    if (entries_.size() >= capacity_) {
+        if (!fresh) {
+            return;
+        }
+        index_.erase(entries_.back().first);
+        entries_.pop_back();
+    }
+    auto position = fresh ? entries_.begin() : entries_.end();
+    index_[channel_id] = entries_.emplace(position, channel_id, uploads);
+}
+
+void UploadsCache::persist(const string &path) {
+    lock_guard<mutex> lock(mutex_);
+    path_ = path;
+
+    ifstream in(path);
+    if (!in) {
+        return;
+    }
+    json::Value root;
+    if (!json::Reader().parse(in, root) || !root.isArray()) {
+        cerr << "Ignoring unreadable uploads cache: " << path << endl;
+        return;
+    }
+    // Saved most recently used first, and entries learned this run are
+    // newer still
+    for (json::ArrayIndex i = 0; i < root.size(); ++i) {
+        const json::Value &entry = root[i];
+        if (!entry.isArray() || entry.size() != 2 || !entry[0].isString()
+                || !entry[1].isString()) {
+            continue;
+        }
+        string channel_id = entry[0].asString();
+        if (index_.find(channel_id) == index_.end()) {
+            insert(channel_id, entry[1].asString(), false);
+        }
+    }
+}
+
+void UploadsCache::save() {
+    lock_guard<mutex> lock(mutex_);
+    if (path_.empty() || !dirty_) {
+        return;
+    }
+
+    json::Value root(json::arrayValue);
+    for (const auto &entry : entries_) {
+        json::Value item(json::arrayValue);
+        item.append(entry.first);
+        item.append(entry.second);
+        root.append(item);
+    }
+
+    // Write aside and rename, so a crash never leaves half a file
+    string temp = path_ + ".tmp";
+    {
+        ofstream out(temp);
+        out << json::FastWriter().write(root);
+        if (!out) {
+            cerr << "Could not write uploads cache: " << temp << endl;
+            return;
+        }
+    }
+    if (rename(temp.c_str(), path_.c_str()) != 0) {
+        cerr << "Could not replace uploads cache: " << path_ << endl;
+        return;
+    }
+    dirty_ = false;
+}
+
+size_t UploadsCache::size() {
+    lock_guard<mutex> lock(mutex_);
+    return entries_.size();
+}
+
+void UploadsCache::clear() {
+    lock_guard<mutex> lock(mutex_);
+    entries_.clear();
+    index_.clear();
+    dirty_ = false;
+}
+
+UploadsCache & UploadsCache::instance() {
+    static UploadsCache cache(
+            env_whole("YOUTUBE_SCOPE_UPLOADS_CACHE_SIZE", DEFAULT_CAPACITY));
+    return cache;
+}
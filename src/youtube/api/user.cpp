@@ -25,6 +25,12 @@ namespace json = Json;
 using namespace youtube::api;
 using namespace std;
 
+const string & User::fields() {
+    static const string FIELDS =
+            "authorDisplayName,authorChannelId/value,authorProfileImageUrl";
+    return FIELDS;
+}
+
 User::User(const json::Value &data) {
     title_ = data["authorDisplayName"].asString();
     id_ = data["authorChannelId"]["value"].asString();
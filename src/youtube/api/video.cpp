@@ -26,6 +26,37 @@ namespace json = Json;
 using namespace youtube::api;
 using namespace std;
 
+namespace {
+// The details every source of a video has in its snippet
+static const string SNIPPET_FIELDS =
+        "title,description,channelId,publishedAt,channelTitle,thumbnails/high/url";
+
+static const string STATISTICS_FIELDS =
+        "statistics(commentCount,dislikeCount,favoriteCount,likeCount,viewCount)";
+}
+
+const string & Video::fields() {
+    static const string FIELDS = "kind,id,snippet(" + SNIPPET_FIELDS + "),"
+            + STATISTICS_FIELDS;
+    return FIELDS;
+}
+
+const string & Video::search_fields() {
+    static const string FIELDS = "kind,id,snippet(" + SNIPPET_FIELDS + ")";
+    return FIELDS;
+}
+
+const string & Video::upload_fields() {
+    static const string FIELDS = "kind,id,snippet(" + SNIPPET_FIELDS
+            + ",resourceId/videoId)";
+    return FIELDS;
+}
+
+const string & Video::statistics_fields() {
+    static const string FIELDS = "kind,id," + STATISTICS_FIELDS;
+    return FIELDS;
+}
+
 Video::Video(const json::Value &data) :
         has_statistics_(false) {
     string kind = data["kind"].asString();
@@ -38,6 +69,9 @@ Video::Video(const json::Value &data) :
     json::Value id = data["id"];
     if (kind == kind_str()) {
         id_ = id.asString();
+    } else if (kind == "youtube#playlistItem") {
+        // An entry of a channel's uploads playlist
+        id_ = snippet["resourceId"]["videoId"].asString();
     } else {
         id_ = id["videoId"].asString();
     }
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <youtube/api/worker-pool.h>
+
+#include <algorithm>
+
+using namespace youtube::api;
+using namespace std;
+
+WorkerPool::WorkerPool(unsigned int threads) {
+    for (unsigned int i = 0; i < max(1u, threads); ++i) {
+        threads_.emplace_back([this]() {
+            work();
+        });
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        lock_guard<mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    jobs_cond_.notify_all();
+
+    for (auto &thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+void WorkerPool::post(const Job &job) {
+    {
+        lock_guard<mutex> lock(mutex_);
+        jobs_.emplace_back(Queued { job, Clock::now() });
+        stats_.peak_queued = max(stats_.peak_queued, jobs_.size());
+    }
+    jobs_cond_.notify_one();
+}
+
+size_t WorkerPool::queued() {
+    lock_guard<mutex> lock(mutex_);
+    return jobs_.size();
+}
+
+size_t WorkerPool::size() const {
+    return threads_.size();
+}
+
+WorkerPool::Stats WorkerPool::stats() {
+    lock_guard<mutex> lock(mutex_);
+    Stats stats = stats_;
+    stats.queued = jobs_.size();
+    return stats;
+}
+
+void WorkerPool::work() {
+    while (true) {
+        Queued queued;
+        {
+            unique_lock<mutex> lock(mutex_);
+            jobs_cond_.wait(lock, [this]() {
+                return stopping_ || !jobs_.empty();
+            });
+            if (jobs_.empty()) {
+                return;
+            }
+            queued = move(jobs_.front());
+            jobs_.pop_front();
+        }
+
+        auto started = Clock::now();
+        queued.job();
+        auto finished = Clock::now();
+
+        lock_guard<mutex> lock(mutex_);
+        ++stats_.completed;
+        stats_.waiting += started - queued.posted;
+        stats_.running += finished - started;
+    }
+}
+
+WorkerPool & WorkerPool::background() {
+    static WorkerPool pool(1);
+    return pool;
+}
@@ -19,7 +19,10 @@
 
 #include <boost/algorithm/string.hpp>
 
+#include <youtube/api/trace.h>
 #include <youtube/scope/activation.h>
+#include <youtube/scope/department-cache.h>
+#include <youtube/scope/result-cache.h>
 #include <unity/scopes/ActivationResponse.h>
 #include <unity/scopes/ActionMetadata.h>
 
@@ -33,7 +36,7 @@ using namespace youtube::scope;
 using namespace youtube::api;
 
 template<typename T>
-static T get_or_throw(future<T> &f) {
+static T get_or_throw(const Task<T> &f) {
     if (f.wait_for(std::chrono::seconds(10)) != future_status::ready) {
         throw domain_error("HTTP request timeout");
     }
@@ -43,13 +46,18 @@ static T get_or_throw(future<T> &f) {
 Activation::Activation(const sc::Result &result,
                const sc::ActionMetadata &metadata,
                std::string const& action_id,
-               std::shared_ptr<sc::OnlineAccountClient> oa_client) : 
+               std::shared_ptr<sc::OnlineAccountClient> oa_client,
+               SubscriptionIndex::Ptr subscriptions) :
     sc::ActivationQueryBase(result, metadata), 
     action_id_(action_id),
-    client_(oa_client) {
+    client_(oa_client),
+    subscriptions_(subscriptions) {
+    client_.set_priority(Priority::interactive);
 }
 
 sc::ActivationResponse Activation::activate() {
+    Span span("activate " + action_id_);
+
     try {
         string vid = result()["uri"].get_string();
         string fav_listid = result()["fav_playlist"].get_string();
@@ -58,46 +66,61 @@ sc::ActivationResponse Activation::activate() {
         if (action_id_ == "commented") {
             string comments = action_metadata().scope_data().get_dict()["comment"].get_string();
 
-            future<bool> post_future = client_.post_comments(vid, comments);
+            Task<bool> post_future = client_.post_comments(vid, comments);
             auto status = get_or_throw(post_future);
             cout<< "auth user post a comment: " << status << endl;
 
             return sc::ActivationResponse(sc::ActivationResponse::Status::ShowPreview);
         } else if (action_id_ == "thumb_up") {
-            future<bool> like_future = client_.rate(vid, true);
+            Task<bool> like_future = client_.rate(vid, true);
             auto status = get_or_throw(like_future);
+            // Likes, playlists and subscriptions show up in query results
+            ResultCache::instance().clear();
             cout<< "auth user likes video: " << status << endl;
 
             return sc::ActivationResponse(sc::ActivationResponse::Status::ShowPreview);
         } else if (action_id_ == "thumb_down") {
-            future<bool> ret_future = client_.rate(vid, false);
+            Task<bool> ret_future = client_.rate(vid, false);
             auto status = get_or_throw(ret_future);
+            ResultCache::instance().clear();
             cout<< "auth user dislike video: " << status << endl;
 
             return sc::ActivationResponse(sc::ActivationResponse::Status::ShowPreview);
         } else if (action_id_ == "add_fav_list") {
-            future<bool> fav_future = client_.addVideoIntoPlayList(vid, fav_listid);
+            Task<bool> fav_future = client_.addVideoIntoPlayList(vid, fav_listid);
             auto status = get_or_throw(fav_future);
+            ResultCache::instance().clear();
             cout<< "auth user add video in fav list: " << status << endl;
 
             return sc::ActivationResponse(sc::ActivationResponse::Status::ShowPreview);
         } else if (action_id_ == "add_watch_list") {
-            future<bool> watch_future = client_.addVideoIntoPlayList(vid, watch_listid);
+            Task<bool> watch_future = client_.addVideoIntoPlayList(vid, watch_listid);
             auto status = get_or_throw(watch_future);
+            ResultCache::instance().clear();
             cout<< "auth user add video in watch later list: " << status << endl;
 
             return sc::ActivationResponse(sc::ActivationResponse::Status::ShowPreview);
         } else if (alg::starts_with(action_id_,"subscribe:")) {
             auto cid = action_id_.substr(string("subscribe:").length());
-            future<bool> subscribe_future = client_.subscribe(cid);
-            auto status = get_or_throw(subscribe_future);
-            cout<< "auth user subscribe channel: " << status << endl;
+            Task<string> subscribe_future = client_.subscribe(cid);
+            auto subscription_id = get_or_throw(subscribe_future);
+            ResultCache::instance().clear();
+            DepartmentCache::instance().subscriptions_changed();
+            if (subscriptions_) {
+                subscriptions_->subscribed(cid, subscription_id);
+            }
+            cout<< "auth user subscribe channel: " << !subscription_id.empty() << endl;
 
             return sc::ActivationResponse(sc::ActivationResponse::Status::ShowPreview);
         } else if (alg::starts_with(action_id_,"unsubscribe:")) {
             auto cid = action_id_.substr(string("unsubscribe:").length());
-            future<bool> unsubscribe_future = client_.unSubscribe(cid);
+            Task<bool> unsubscribe_future = client_.unSubscribe(cid);
             auto status = get_or_throw(unsubscribe_future);
+            ResultCache::instance().clear();
+            DepartmentCache::instance().subscriptions_changed();
+            if (subscriptions_) {
+                subscriptions_->unsubscribed(cid);
+            }
             cout<< "auth user unsubscribe channel: " << status << endl;
 
             return sc::ActivationResponse(sc::ActivationResponse::Status::ShowPreview);
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <youtube/scope/chart-cache.h>
+
+#include <youtube/api/environment.h>
+
+using namespace std;
+using namespace youtube::api;
+using namespace youtube::scope;
+
+const string ChartCache::MUSIC_CATEGORY_ID = "10";
+
+ChartCache::ChartCache(const Clock::duration &ttl) :
+        ttl_(ttl), store_(make_shared<Store>()) {
+}
+
+ChartCache::Clock::duration ChartCache::ttl() const {
+    return ttl_;
+}
+
+string ChartCache::key(const string &region, const string &category_id) {
+    return region + ':' + category_id;
+}
+
+bool ChartCache::get(const string &key, Client::VideoList &videos) {
+    lock_guard<mutex> lock(store_->mutex);
+    auto it = store_->entries.find(key);
+    if (it == store_->entries.end()) {
+        return false;
+    }
+    if (Clock::now() - it->second.stored > ttl_) {
+        store_->entries.erase(it);
+        return false;
+    }
+    videos = it->second.videos;
+    return true;
+}
+
+void ChartCache::put(const string &key, const Client::VideoList &videos) {
+    put(*store_, key, videos);
+}
+
+void ChartCache::put(Store &store, const string &key,
+        const Client::VideoList &videos) {
+    lock_guard<mutex> lock(store.mutex);
+    store.entries[key] = Entry { videos, Clock::now() };
+}
+
+Task<Client::VideoList> ChartCache::fetch(Client &client, const string &region,
+        const string &category_id) {
+    string chart_key = key(region, category_id);
+    weak_ptr<Store> weak_store(store_);
+    return client.chart_videos("mostPopular", region, category_id).then(
+            [weak_store, chart_key](const Client::VideoList &videos) {
+                auto store = weak_store.lock();
+                if (store) {
+                    put(*store, chart_key, videos);
+                }
+                return videos;
+            });
+}
+
+void ChartCache::clear() {
+    lock_guard<mutex> lock(store_->mutex);
+    store_->entries.clear();
+}
+
+ChartCache & ChartCache::instance() {
+    static ChartCache cache(
+            chrono::seconds(env_whole("YOUTUBE_SCOPE_CHART_CACHE_TTL", 900)));
+    return cache;
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <youtube/scope/chart-refresher.h>
+
+#include <youtube/api/environment.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+using namespace std;
+using namespace youtube::api;
+using namespace youtube::scope;
+
+ChartRefresher::ChartRefresher(ChartCache &cache, shared_ptr<Client> client,
+        const Clock::duration &min_interval) :
+        cache_(cache), client_(client), idle_(chrono::hours(1)) {
+    // Leave time for a refresh to land before the last one expires
+    max_interval_ = max(cache_.ttl() * 2 / 3, Clock::duration(chrono::seconds(1)));
+    min_interval_ = min(min_interval, max_interval_);
+
+    thread_ = thread([this]() {
+        run();
+    });
+}
+
+ChartRefresher::~ChartRefresher() {
+    {
+        lock_guard<mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_cond_.notify_all();
+
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    // Refreshes still in flight would land in a cache that may be going
+    // away too. A continuation already running on the parser pool can
+    // outlive this and drop the last reference to the client there, which
+    // the client allows for.
+    client_->cancel();
+    client_.reset();
+}
+
+void ChartRefresher::requested(const string &region,
+        const string &category_id) {
+    auto now = Clock::now();
+    {
+        lock_guard<mutex> lock(mutex_);
+        string key = ChartCache::key(region, category_id);
+        auto it = watched_.find(key);
+        if (it == watched_.end()) {
+            // The query fetches it this time, so the first refresh is due
+            // a full interval from now
+            watched_[key] = Watched { region, category_id, now,
+                    Clock::duration::zero(), now };
+        } else {
+            Watched &watched = it->second;
+            Clock::duration gap = max(now - watched.last_requested,
+                    Clock::duration(1));
+            watched.mean_gap =
+                    watched.mean_gap == Clock::duration::zero() ?
+                            gap : (watched.mean_gap * 3 + gap) / 4;
+            watched.last_requested = now;
+        }
+    }
+    wake_cond_.notify_all();
+}
+
+void ChartRefresher::warm(const string &region) {
+    auto now = Clock::now();
+    {
+        lock_guard<mutex> lock(mutex_);
+        for (const string &category_id : { string(),
+                ChartCache::MUSIC_CATEGORY_ID }) {
+            string key = ChartCache::key(region, category_id);
+            if (watched_.find(key) == watched_.end()) {
+                watched_[key] = Watched { region, category_id, now,
+                        Clock::duration::zero(), Clock::time_point() };
+            }
+        }
+    }
+    wake_cond_.notify_all();
+}
+
+ChartRefresher::Clock::duration ChartRefresher::interval(const string &region,
+        const string &category_id) {
+    lock_guard<mutex> lock(mutex_);
+    auto it = watched_.find(ChartCache::key(region, category_id));
+    if (it == watched_.end()) {
+        return Clock::duration::zero();
+    }
+    return interval(it->second);
+}
+
+ChartRefresher::Clock::duration ChartRefresher::interval(
+        const Watched &watched) const {
+    if (watched.mean_gap == Clock::duration::zero()) {
+        return max_interval_;
+    }
+    return min(max_interval_, max(min_interval_, watched.mean_gap));
+}
+
+void ChartRefresher::run() {
+    unique_lock<mutex> lock(mutex_);
+    while (!stopping_) {
+        auto now = Clock::now();
+        auto next = now + max_interval_;
+
+        vector<pair<string, string>> due;
+        for (auto it = watched_.begin(); it != watched_.end();) {
+            Watched &watched = it->second;
+            if (now - watched.last_requested > idle_) {
+                it = watched_.erase(it);
+                continue;
+            }
+            if (watched.refreshed + interval(watched) <= now) {
+                due.emplace_back(watched.region, watched.category_id);
+                watched.refreshed = now;
+            }
+            next = min(next, watched.refreshed + interval(watched));
+            ++it;
+        }
+
+        if (!due.empty()) {
+            // Fetching only starts the requests, failures are left for
+            // the next refresh or the query to deal with
+            lock.unlock();
+            for (const auto &chart : due) {
+                cache_.fetch(*client_, chart.first, chart.second);
+            }
+            lock.lock();
+            continue;
+        }
+
+        wake_cond_.wait_until(lock, next);
+    }
+}
+
+ChartRefresher::Ptr ChartRefresher::create(shared_ptr<Client> client) {
+    return make_shared<ChartRefresher>(ChartCache::instance(), client,
+            chrono::seconds(
+                    env_whole("YOUTUBE_SCOPE_CHART_REFRESH_MIN", 120)));
+}
@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <youtube/scope/department-cache.h>
+
+#include <youtube/api/environment.h>
+
+namespace sc = unity::scopes;
+
+using namespace std;
+using namespace youtube::api;
+using namespace youtube::scope;
+
+namespace {
+
+static sc::Department::SPtr copy(const sc::Department::SCPtr &department,
+        const sc::CannedQuery &query) {
+    sc::Department::SPtr result = sc::Department::create(department->id(),
+            query, department->label());
+    for (const auto &subdepartment : department->subdepartments()) {
+        result->add_subdepartment(copy(subdepartment, query));
+    }
+    return result;
+}
+
+}
+
+constexpr size_t DepartmentCache::MAX_BOUND;
+
+DepartmentCache::DepartmentCache(const Clock::duration &ttl) :
+        ttl_(ttl) {
+}
+
+string DepartmentCache::key(const string &region, const string &locale,
+        bool authenticated, const string &account_id) {
+    return region + '\x1f' + locale + '\x1f' + (authenticated ? "1" : "0")
+            + '\x1f' + account_id;
+}
+
+bool DepartmentCache::get(const string &key, Tree &tree) {
+    lock_guard<mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        return false;
+    }
+    if (Clock::now() - it->second.stored > ttl_) {
+        entries_.erase(it);
+        return false;
+    }
+    tree = it->second.tree;
+    return true;
+}
+
+void DepartmentCache::put(const string &key, const Tree &tree,
+        unsigned long version) {
+    lock_guard<mutex> lock(mutex_);
+    if (version != version_) {
+        return;
+    }
+    Entry &entry(entries_[key]);
+    entry.tree = tree;
+    entry.stored = Clock::now();
+    entry.bound.clear();
+}
+
+unsigned long DepartmentCache::version() {
+    lock_guard<mutex> lock(mutex_);
+    return version_;
+}
+
+void DepartmentCache::subscriptions_changed() {
+    lock_guard<mutex> lock(mutex_);
+    ++version_;
+    entries_.clear();
+}
+
+void DepartmentCache::clear() {
+    lock_guard<mutex> lock(mutex_);
+    entries_.clear();
+}
+
+sc::Department::SCPtr DepartmentCache::bind(const string &key,
+        const Tree &tree, const sc::CannedQuery &query,
+        const string &department_id) {
+    if (!tree.root) {
+        return nullptr;
+    }
+
+    string bound_key = query.to_uri() + '\x1f' + department_id;
+    {
+        lock_guard<mutex> lock(mutex_);
+        auto it = entries_.find(key);
+        if (it != entries_.end() && it->second.tree.root == tree.root) {
+            auto bound = it->second.bound.find(bound_key);
+            if (bound != it->second.bound.end()) {
+                return bound->second;
+            }
+        }
+    }
+
+    sc::Department::SCPtr root =
+            department_id.empty() ?
+                    for_query(tree, query) :
+                    with_subdepartment(tree, query, department_id);
+
+    lock_guard<mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    // Only kept while the tree it was bound from is
+    if (it != entries_.end() && it->second.tree.root == tree.root
+            && it->second.bound.size() < MAX_BOUND) {
+        it->second.bound[bound_key] = root;
+    }
+    return root;
+}
+
+sc::Department::SCPtr DepartmentCache::for_query(const Tree &tree,
+        const sc::CannedQuery &query) {
+    if (!tree.root) {
+        return nullptr;
+    }
+    return copy(tree.root, query);
+}
+
+sc::Department::SCPtr DepartmentCache::with_subdepartment(const Tree &tree,
+        const sc::CannedQuery &query, const string &department_id) {
+    if (!tree.root) {
+        return nullptr;
+    }
+    sc::Department::SPtr root = copy(tree.root, query);
+    root->add_subdepartment(sc::Department::create(department_id, query, " "));
+    return root;
+}
+
+DepartmentCache & DepartmentCache::instance() {
+    static DepartmentCache cache(
+            chrono::seconds(
+                    env_whole("YOUTUBE_SCOPE_DEPARTMENT_CACHE_TTL", 600)));
+    return cache;
+}
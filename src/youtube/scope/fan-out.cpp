@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <youtube/scope/fan-out.h>
+
+#include <youtube/api/environment.h>
+
+#include <algorithm>
+
+using namespace std;
+using namespace youtube::api;
+using namespace youtube::scope;
+
+FanOut::FanOut(unsigned int width, unsigned int min_width,
+        unsigned int max_width, const chrono::milliseconds &target_latency) :
+        width_(width), min_width_(min_width), max_width_(max_width), target_latency_(
+                target_latency) {
+}
+
+unsigned int FanOut::width() {
+    lock_guard<mutex> lock(mutex_);
+    return width_;
+}
+
+void FanOut::pin(unsigned int width) {
+    lock_guard<mutex> lock(mutex_);
+    width_ = min_width_ = max_width_ = max(1u, width);
+}
+
+void FanOut::record(const Clock::duration &latency, bool failed) {
+    lock_guard<mutex> lock(mutex_);
+
+    if (failed || latency > target_latency_) {
+        // Back off hard, we are probably being rate limited
+        width_ = max(min_width_, width_ / 2);
+        successes_ = 0;
+        return;
+    }
+
+    if (++successes_ >= width_) {
+        width_ = min(max_width_, width_ + 1);
+        successes_ = 0;
+    }
+}
+
+FanOut & FanOut::shared() {
+    static FanOut instance(4, 1, 16, chrono::milliseconds(2000));
+
+    // Pinning the width is mostly useful for benchmarking
+    static bool configured = [] {
+        unsigned long pinned = env_whole("YOUTUBE_SCOPE_FANOUT_WIDTH", 0);
+        if (pinned > 0) {
+            instance.pin(pinned);
+        }
+        return true;
+    }();
+    (void) configured;
+
+    return instance;
+}
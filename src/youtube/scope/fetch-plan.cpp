@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <youtube/scope/fetch-plan.h>
+
+#include <algorithm>
+
+using namespace std;
+using namespace youtube::scope;
+
+FetchPlan::FetchPlan(int cardinality, unsigned int per_source) :
+        cardinality_(max(0, cardinality)), per_source_(max(1u, per_source)) {
+}
+
+bool FetchPlan::unlimited() const {
+    return cardinality_ == 0;
+}
+
+bool FetchPlan::met() const {
+    return !unlimited() && pushed_ >= cardinality_;
+}
+
+unsigned int FetchPlan::remaining() const {
+    if (unlimited() || met()) {
+        return 0;
+    }
+    return cardinality_ - pushed_;
+}
+
+unsigned int FetchPlan::per_source() const {
+    if (unlimited()) {
+        return per_source_;
+    }
+    return max(1u, min(per_source_, remaining()));
+}
+
+bool FetchPlan::wants(size_t outstanding) const {
+    if (unlimited()) {
+        return true;
+    }
+    // Sources can come back short, so this only holds off requests that
+    // would be surplus if the ones in flight deliver in full
+    return outstanding * per_source_ < remaining();
+}
+
+bool FetchPlan::pushed() {
+    ++pushed_;
+    return !met();
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <youtube/scope/number-formatter.h>
+
+#include <algorithm>
+#include <climits>
+#include <stdexcept>
+
+using namespace std;
+using namespace youtube::scope;
+
+NumberFormatter::NumberFormatter(const locale &locale) {
+    const auto &punct = use_facet<numpunct<char>>(locale);
+    grouping_ = punct.grouping();
+    separator_ = punct.thousands_sep();
+}
+
+string NumberFormatter::format(long long number) const {
+    // Negate as unsigned, so the most negative number survives
+    unsigned long long magnitude =
+            number < 0 ? 0ull - static_cast<unsigned long long>(number) : number;
+
+    // Digits are written least significant first, then reversed
+    string result;
+    result.reserve(32);
+
+    size_t group = 0;
+    int group_size = grouping_.empty() ? 0 : grouping_[0];
+    int in_group = 0;
+    do {
+        if (group_size > 0 && group_size != CHAR_MAX && in_group == group_size) {
+            result += separator_;
+            in_group = 0;
+            // The last group size repeats
+            if (group + 1 < grouping_.size()) {
+                group_size = grouping_[++group];
+            }
+        }
+        result += static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+        ++in_group;
+    } while (magnitude > 0);
+
+    if (number < 0) {
+        result += '-';
+    }
+    reverse(result.begin(), result.end());
+    return result;
+}
+
+const NumberFormatter & NumberFormatter::user() {
+    static const NumberFormatter instance([]() {
+        try {
+            return locale("");
+        } catch (runtime_error &e) {
+            // LANG names a locale that is not installed
+            return locale::classic();
+        }
+    }());
+    return instance;
+}
+
+string youtube::scope::format_fixed(long long number) {
+    return NumberFormatter::user().format(number);
+}
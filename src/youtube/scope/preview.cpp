@@ -18,7 +18,9 @@
  */
 #include <boost/algorithm/string/replace.hpp>
 
+#include <youtube/api/trace.h>
 #include <youtube/scope/localisation.h>
+#include <youtube/scope/number-formatter.h>
 #include <youtube/scope/preview.h>
 
 #include <unity/scopes/ColumnLayout.h>
@@ -37,14 +39,12 @@ using namespace std;
 using namespace youtube::scope;
 using namespace youtube::api;
 
-extern string format_fixed(long long number);
-
 namespace {
 static const unordered_set<string> PLAYABLE = { "youtube#video",
         "youtube#playlistItem" };
 
 template<typename T>
-static T get_or_throw(future<T> &f) {
+static T get_or_throw(const Task<T> &f) {
     if (f.wait_for(std::chrono::seconds(10)) != future_status::ready) {
         throw domain_error("HTTP request timeout");
     }
@@ -53,20 +53,40 @@ static T get_or_throw(future<T> &f) {
 }
 
 Preview::Preview(const sc::Result &result, const sc::ActionMetadata &metadata,
-                 std::shared_ptr<sc::OnlineAccountClient> oa_client) :
+                 std::shared_ptr<sc::OnlineAccountClient> oa_client,
+                 SubscriptionIndex::Ptr subscriptions) :
         sc::PreviewQueryBase(result, metadata),
-        client_(oa_client) {
+        client_(oa_client), subscriptions_(subscriptions) {
+    // The user is waiting on the preview, so it goes ahead of any fan-out
+    client_.set_priority(Priority::interactive);
 }
 
 void Preview::cancelled() {
+    client_.cancel();
 }
 
 void Preview::playable(const sc::PreviewReplyProxy& reply) {
-    auto videos_future = client_.videos(result().uri());
-    auto videos = videos_future.get();
-    auto v = videos.front();
-    auto s = v->statistics();
-    auto cid = v->channelId();
+    Span span("preview-playable");
+
+    // Results for videos bring everything but the statistics with them,
+    // other playable results only have the video id
+    string username, published_at, cid;
+    Video::Statistics s;
+    if (result().contains("channel_id")
+            && !result()["channel_id"].get_string().empty()) {
+        username = result()["subtitle"].get_string();
+        published_at = result()["published_at"].get_string();
+        cid = result()["channel_id"].get_string();
+        s = get_or_throw(client_.video_statistics(result().uri()));
+    } else {
+        auto videos_future = client_.videos(result().uri());
+        auto videos = videos_future.get();
+        auto v = videos.front();
+        username = v->username();
+        published_at = v->publishedAt();
+        cid = v->channelId();
+        s = v->statistics();
+    }
 
     sc::PreviewWidgetList widgets;
     std::vector<std::string> ids;
@@ -94,7 +114,7 @@ void Preview::playable(const sc::PreviewReplyProxy& reply) {
     sc::PreviewWidget w_expandable("expandable", "expandable");
     w_expandable.add_attribute_value("collapsed-widgets", sc::Variant(2));
     sc::PreviewWidget w_publish("publish", "text");
-    string publishInfo = "<b>" + v->username() +_("<br/>  Published on: </b>") + v->publishedAt();
+    string publishInfo = "<b>" + username +_("<br/>  Published on: </b>") + published_at;
 
     if(!client_.authenticated()) {
         ids.emplace_back("tips-id");
@@ -121,13 +141,19 @@ void Preview::playable(const sc::PreviewReplyProxy& reply) {
         sc::VariantBuilder builder;
         sc::PreviewWidget actions("actions", "actions");
         {
-            auto subscribed_future = client_.subscribeId(cid);
-            auto subsribedList = get_or_throw(subscribed_future);
+            string subscription_id;
+            if (!subscriptions_ || !subscriptions_->lookup(cid, subscription_id)) {
+                auto subscribed_future = client_.subscribeId(cid);
+                auto subsribedList = get_or_throw(subscribed_future);
+                if (subsribedList.size() > 0) {
+                    subscription_id = subsribedList[0]->subscribeId();
+                }
+            }
 
             builder.add_tuple({
-                  {"id", sc::Variant(subsribedList.size() > 0 ?
-                   "unsubscribe:" + subsribedList[0]->subscribeId() : "subscribe:" + cid)},
-                  {"label", sc::Variant(_(subsribedList.size() > 0 ? _("Unsubscribe"): _("Subscribe")))}
+                  {"id", sc::Variant(!subscription_id.empty() ?
+                   "unsubscribe:" + subscription_id : "subscribe:" + cid)},
+                  {"label", sc::Variant(_(!subscription_id.empty() ? _("Unsubscribe"): _("Subscribe")))}
               });
             builder.add_tuple({
                   {"id", sc::Variant("thumb_up")},
@@ -162,7 +188,7 @@ void Preview::playable(const sc::PreviewReplyProxy& reply) {
         widgets.emplace_back(w_commentInput);
 
         int index = 0;
-        auto commentlist_future = client_.video_comments(v->id());
+        auto commentlist_future = client_.video_comments(result().uri());
         for (const auto &comment : get_or_throw(commentlist_future)) {
             std::string id = "commentId_"+ std::to_string(index++);
             ids.emplace_back(id);
@@ -216,6 +242,8 @@ void Preview::playable(const sc::PreviewReplyProxy& reply) {
 }
 
 void Preview::playlist(const sc::PreviewReplyProxy& reply) {
+    Span span("preview-playlist");
+
     sc::ColumnLayout layout1col(1), layout2col(2), layout3col(3);
     layout1col.add_column( { "image", "header", "summary", "actions" });
     layout2col.add_column( { "image" });
@@ -252,6 +280,8 @@ void Preview::playlist(const sc::PreviewReplyProxy& reply) {
 }
 
 void Preview::userInfo(const sc::PreviewReplyProxy& reply) {
+    Span span("preview-user-info");
+
     sc::ColumnLayout layout1col(1), layout2col(2), layout3col(3);
     layout1col.add_column( { "header", "art", "statistics", "description", "actions" });
     layout2col.add_column( { "header" });
@@ -306,11 +336,15 @@ void Preview::userInfo(const sc::PreviewReplyProxy& reply) {
 void Preview::run(sc::PreviewReplyProxy const& reply) {
     string kind = result()["kind"].get_string();
 
-    if (kind == "user-info"){
-        userInfo(reply);
-    } else if (PLAYABLE.find(kind) == PLAYABLE.end()) {
-        playlist(reply);
-    } else {
-        playable(reply);
+    try {
+        if (kind == "user-info"){
+            userInfo(reply);
+        } else if (PLAYABLE.find(kind) == PLAYABLE.end()) {
+            playlist(reply);
+        } else {
+            playable(reply);
+        }
+    } catch (Cancelled &e) {
+        // Nobody is waiting for this preview any more
     }
 }
@@ -24,9 +24,16 @@
 #include <youtube/api/subscription.h>
 #include <youtube/api/subscription-item.h>
 #include <youtube/api/playlist.h>
+#include <youtube/api/trace.h>
 
+#include <youtube/scope/chart-cache.h>
+#include <youtube/scope/department-cache.h>
+#include <youtube/scope/fan-out.h>
+#include <youtube/scope/fetch-plan.h>
 #include <youtube/scope/localisation.h>
+#include <youtube/scope/number-formatter.h>
 #include <youtube/scope/query.h>
+#include <youtube/scope/result-cache.h>
 
 #include <unity/scopes/Annotation.h>
 #include <unity/scopes/CategorisedResult.h>
@@ -47,17 +54,12 @@ using namespace std;
 using namespace youtube::api;
 using namespace youtube::scope;
 
-extern string format_fixed(long long number) {
-    string n = to_string(number);
-    std::stringstream ss;
-    ss.imbue(std::locale(""));
-    ss << std::fixed << stoll(n);
-    return ss.str();
-}
-
 namespace {
 static constexpr bool DEBUG_MODE = false;
 
+// What the API returns per request when maxResults is not given
+static constexpr unsigned int PAGE_SIZE = 5;
+
 const static string BROWSE_TEMPLATE =
         R"(
 {
@@ -194,11 +196,11 @@ const static string EMPTY_VIDEOS_TIPS =
 }
 )";
 
-const static string MUSIC_CATEGORY_ID = "10";
+const static string &MUSIC_CATEGORY_ID = ChartCache::MUSIC_CATEGORY_ID;
 const static string MUSIC_AGGREGATOR_DEPT = "musicaggregator";
 
 template<typename T>
-static T get_or_throw(future<T> &f) {
+static T get_or_throw(const Task<T> &f) {
     if (f.wait_for(std::chrono::seconds(10)) != future_status::ready) {
         throw domain_error("HTTP request timeout");
     }
@@ -296,7 +298,18 @@ struct DepartmentPath {
     }
 };
 
-void push_resource(const sc::SearchReplyProxy &reply, const sc::Category::SCPtr &category,
+/*
+ * The shell stops taking results once the query is finished or cancelled,
+ * after which there is no point in fetching any more
+ */
+void push_or_stop(const RecordingReply::Ptr &reply,
+        const sc::CategorisedResult &res) {
+    if (!reply->push(res)) {
+        throw Cancelled();
+    }
+}
+
+void push_resource(const RecordingReply::Ptr &reply, const sc::Category::SCPtr &category,
                    const Resource::Ptr &resource, map<string, string> &playlist) {
     sc::CategorisedResult res(category);
     res.set_title(resource->title());
@@ -376,6 +389,9 @@ void push_resource(const sc::SearchReplyProxy &reply, const sc::Category::SCPtr
         res["description"] = video->description();
         res["subtitle"] = video->username();
         res.set_uri(video->id());
+        // Saves the preview fetching the whole video again
+        res["channel_id"] = video->channelId();
+        res["published_at"] = video->publishedAt();
         // add a flag that will determine if this version of the youtube scope
         // processes the department "aggregated:musicaggregator"
         res["musicaggregation"]=true;
@@ -385,12 +401,10 @@ void push_resource(const sc::SearchReplyProxy &reply, const sc::Category::SCPtr
       break;
     }
 
-    if (!reply->push(res)) {
-        return;
-    }
+    push_or_stop(reply, res);
 }
 
-void push_channel_info(const sc::SearchReplyProxy &reply,
+void push_channel_info(const RecordingReply::Ptr &reply,
     const sc::Category::SCPtr &category, const Channel::Ptr &channel) {
 
     sc::CategorisedResult res(category);
@@ -419,14 +433,12 @@ void push_channel_info(const sc::SearchReplyProxy &reply,
 
     res["kind"] = "user-info";
 
-    if (!reply->push(res)) {
-        return;
-}
+    push_or_stop(reply, res);
 }
 
 void push_tips(const sc::CannedQuery &query,
                const std::string &tips,
-               const unity::scopes::SearchReplyProxy &reply) {
+               const RecordingReply::Ptr &reply) {
     //Stay on surface and avoid user to enter card view if no videos are found
     sc::CategoryRenderer rdr(EMPTY_VIDEOS_TIPS);
     auto cat = reply->register_category("empty_tips", "", "", rdr);
@@ -435,24 +447,23 @@ void push_tips(const sc::CannedQuery &query,
     res.set_uri(query.to_uri());
     res.set_title(tips);
 
-    if (!reply->push(res)) {
-        return;
-    }
+    push_or_stop(reply, res);
 }
 
 }
 
 Query::Query(const sc::CannedQuery &query, const sc::SearchMetadata &metadata,
-             std::shared_ptr<sc::OnlineAccountClient> oa_client) :
+             std::shared_ptr<sc::OnlineAccountClient> oa_client,
+             ChartRefresher::Ptr chart_refresher) :
         sc::SearchQueryBase(query, metadata),
-        client_(oa_client) {
+        client_(oa_client), chart_refresher_(chart_refresher) {
 }
 
 void Query::cancelled() {
     client_.cancel();
 }
 
-void Query::add_login_nag(const sc::SearchReplyProxy &reply) {
+void Query::add_login_nag(const RecordingReply::Ptr &reply) {
     sc::CategoryRenderer rdr(SEARCH_CATEGORY_LOGIN_NAG);
     auto cat = reply->register_category("youtube_login_nag", "", "", rdr);
 
@@ -465,11 +476,13 @@ void Query::add_login_nag(const sc::SearchReplyProxy &reply) {
                                           sc::OnlineAccountClient::InvalidateResults,
                                           sc::OnlineAccountClient::DoNothing);
 
-    reply->push(res);
+    push_or_stop(reply, res);
 }
 
-void Query::guide_category(const sc::SearchReplyProxy &reply,
+void Query::guide_category(const RecordingReply::Ptr &reply,
         const string &department_id) {
+    Span span("guide-category");
+
     auto popular = reply->register_category("youtube-popular", "", "",
             sc::CategoryRenderer(POPULAR_TEMPLATE));
 
@@ -480,45 +493,54 @@ void Query::guide_category(const sc::SearchReplyProxy &reply,
 
     auto channels_future = client_.category_channels(department_id);
     auto channels = get_or_throw(channels_future);
-    deque<future<Client::ChannelSectionList>> channel_section_futures;
-    for (Channel::Ptr channel : channels) {
-        channel_section_futures.emplace_back(
-                client_.channel_sections(channel->id(), 1));
-        if (DEBUG_MODE) {
-            cerr << "  channel: " << channel->id() << " " << channel->title()
-                    << endl;
-        }
-    }
 
-    int channel_number = 0;
-    for (future<Client::ChannelSectionList> &channel_section_future : channel_section_futures) {
-        Channel::Ptr channel = channels.at(channel_number++);
+    // Each channel brings one page of its featured playlist
+    FetchPlan plan(search_metadata().cardinality(), PAGE_SIZE);
 
-        Client::ChannelSectionList sections = get_or_throw(
-                channel_section_future);
+    // First find the playlist each channel features
+    deque<pair<Channel::Ptr, ChannelSection::Ptr>> sections;
+    {
+        Span sections_span("channel-sections");
+        FanOut::shared().run(channels, [this](const Channel::Ptr &channel) {
+            if (DEBUG_MODE) {
+                cerr << "  channel: " << channel->id() << " " << channel->title()
+                        << endl;
+            }
+            return client_.channel_sections(channel->id(), 1);
+        }, [&sections](const Channel::Ptr &channel, const Client::ChannelSectionList &channel_sections) {
+            ChannelSection::Ptr section;
+            for (auto it : channel_sections) {
+                if (!it->playlist_id().empty()) {
+                    section = it;
+                    break;
+                }
+            }
 
-        ChannelSection::Ptr section;
-        for (auto it : sections) {
-            if (!it->playlist_id().empty()) {
-                section = it;
-                break;
+            if (!section) {
+                if (DEBUG_MODE) {
+                    cerr << "    empty playlist" << endl;
+                }
+                return;
             }
-        }
 
-        if (!section) {
             if (DEBUG_MODE) {
-                cerr << "    empty playlist" << endl;
+                cerr << "  section: " << section->id() << " " << section->playlist_id()
+                        << endl;
             }
-            continue;
-        }
-
-        if (DEBUG_MODE) {
-            cerr << "  section: " << section->id() << " " << section->playlist_id()
-                    << endl;
-        }
+            sections.emplace_back(channel, section);
+        }, [&plan, &sections](size_t outstanding) {
+            return plan.wants(sections.size() + outstanding);
+        });
+    }
 
-        auto playlist_future = client_.playlist_items(section->playlist_id());
-        Client::PlaylistItemList items = get_or_throw(playlist_future);
+    // Then fetch those playlists
+    Span items_span("playlist-items");
+    FanOut::shared().run(sections, [this](const pair<Channel::Ptr, ChannelSection::Ptr> &section) {
+        return client_.playlist_items(section.second->playlist_id());
+    }, [this, &reply, &popular, &first, &plan](const pair<Channel::Ptr, ChannelSection::Ptr> &section,
+            const Client::PlaylistItemList &items) {
+        Span push_span("push");
+        Channel::Ptr channel = section.first;
 
         auto it = items.cbegin();
 
@@ -528,6 +550,9 @@ void Query::guide_category(const sc::SearchReplyProxy &reply,
                 PlaylistItem::Ptr video(*it);
                 push_resource(reply, popular, video, my_playlist_);
                 ++it;
+                if (!plan.pushed()) {
+                    return;
+                }
             }
         }
 
@@ -536,11 +561,18 @@ void Query::guide_category(const sc::SearchReplyProxy &reply,
         for (; it != items.cend(); ++it) {
             PlaylistItem::Ptr video(*it);
             push_resource(reply, cat, video, my_playlist_);
+            if (!plan.pushed()) {
+                return;
+            }
         }
-    }
+    }, [&plan](size_t outstanding) {
+        return plan.wants(outstanding);
+    });
 }
 
-void Query::subscriptions(const sc::SearchReplyProxy &reply) {
+void Query::subscriptions(const RecordingReply::Ptr &reply) {
+    Span span("subscriptions");
+
     if (DEBUG_MODE) {
         cerr << "Finding subscriptions: " << endl;
     }
@@ -551,13 +583,19 @@ void Query::subscriptions(const sc::SearchReplyProxy &reply) {
     auto subs_future = client_.subscription_channels();
     Client::SubscriptionList items = get_or_throw(subs_future);
 
+    FetchPlan plan(search_metadata().cardinality(), items.size());
     for (auto &item : items) {
         push_resource(reply, cat, item, my_playlist_);
+        if (!plan.pushed()) {
+            break;
+        }
     }
 }
 
-void Query::subscription_videos(const sc::SearchReplyProxy &reply,
+void Query::subscription_videos(const RecordingReply::Ptr &reply,
         const string &department_id) {
+    Span span("subscription-videos");
+
     if (DEBUG_MODE) {
         cerr << "Finding subscription uploads: " << department_id << endl;
     }
@@ -565,19 +603,26 @@ void Query::subscription_videos(const sc::SearchReplyProxy &reply,
     auto cat = reply->register_category("subscription", _("Uploads"), "",
             sc::CategoryRenderer(BROWSE_TEMPLATE));
 
-    auto uploads_future = client_.subscription_channel_uploads(department_id);
-    auto uploads = get_or_throw(uploads_future);
-
-    auto subscription_items_future = client_.subscription_items(uploads);
+    Client &client = client_;
+    auto subscription_items_future = client_.subscription_channel_uploads(
+            department_id).then([&client](const string &uploads) {
+                return client.subscription_items(uploads);
+            });
     Client::SubscriptionItemList items = get_or_throw(subscription_items_future);
 
+    FetchPlan plan(search_metadata().cardinality(), items.size());
     for (auto &subscription_item : items) {
         push_resource(reply, cat, subscription_item, my_playlist_);
+        if (!plan.pushed()) {
+            break;
+        }
     }
 }
 
-void Query::guide_category_videos(const sc::SearchReplyProxy &reply,
+void Query::guide_category_videos(const RecordingReply::Ptr &reply,
         const string &department_id) {
+    Span span("guide-category-videos");
+
     if (DEBUG_MODE) {
         cerr << "Finding videos: " << department_id << endl;
     }
@@ -587,25 +632,28 @@ void Query::guide_category_videos(const sc::SearchReplyProxy &reply,
 
     auto channels_future = client_.category_channels(department_id);
     auto channels = get_or_throw(channels_future);
-    deque<future<Client::VideoList>> videos_futures;
-    for (Channel::Ptr channel : channels) {
+
+    FetchPlan plan(search_metadata().cardinality(), PAGE_SIZE);
+    FanOut::shared().run(channels, [this, &plan](const Channel::Ptr &channel) {
         if (DEBUG_MODE) {
             cerr << "  channel: " << channel->id() << " " << channel->title()
                     << endl;
         }
-        videos_futures.emplace_back(client_.channel_videos(channel->id()));
-    }
-
-    for (auto &it : videos_futures) {
-        Client::VideoList videos = it.get();
+        return client_.channel_videos(channel->id(), plan.per_source(), true);
+    }, [this, &reply, &cat, &plan](const Channel::Ptr &, const Client::VideoList &videos) {
         for (auto &video : videos) {
             if (DEBUG_MODE) {
                 cerr << "    video: " << video->id() << " " << video->title()
                         << endl;
             }
             push_resource(reply, cat, video, my_playlist_);
+            if (!plan.pushed()) {
+                return;
+            }
         }
-    }
+    }, [&plan](size_t outstanding) {
+        return plan.wants(outstanding);
+    });
 
     if (channels.size() == 0) {
         const sc::CannedQuery &query(sc::SearchQueryBase::query());
@@ -614,8 +662,10 @@ void Query::guide_category_videos(const sc::SearchReplyProxy &reply,
 }
 }
 
-void Query::guide_category_channels(const sc::SearchReplyProxy &reply,
+void Query::guide_category_channels(const RecordingReply::Ptr &reply,
         const string &department_id) {
+    Span span("guide-category-channels");
+
     if (DEBUG_MODE) {
         cerr << "Finding channels: " << department_id << endl;
     }
@@ -624,12 +674,16 @@ void Query::guide_category_channels(const sc::SearchReplyProxy &reply,
             sc::CategoryRenderer(SEARCH_TEMPLATE));
     auto channels_future = client_.category_channels(department_id);
     auto channels = get_or_throw(channels_future);
+    FetchPlan plan(search_metadata().cardinality(), channels.size());
     for (Channel::Ptr channel : channels) {
         push_resource(reply, cat, channel, my_playlist_);
         if (DEBUG_MODE) {
             cerr << "  channel: " << channel->id() << " " << channel->title()
                     << endl;
         }
+        if (!plan.pushed()) {
+            break;
+        }
     }
 
     if (channels.size() == 0) {
@@ -639,8 +693,10 @@ void Query::guide_category_channels(const sc::SearchReplyProxy &reply,
 }
 }
 
-void Query::guide_category_playlists(const sc::SearchReplyProxy &reply,
+void Query::guide_category_playlists(const RecordingReply::Ptr &reply,
         const string &department_id) {
+    Span span("guide-category-playlists");
+
     if (DEBUG_MODE) {
         cerr << "Finding playlists: " << department_id << endl;
     }
@@ -650,26 +706,28 @@ void Query::guide_category_playlists(const sc::SearchReplyProxy &reply,
 
     auto channels_future = client_.category_channels(department_id);
     auto channels = get_or_throw(channels_future);
-    deque<future<Client::PlaylistList>> playlists_futures;
-    for (Channel::Ptr channel : channels) {
+
+    FetchPlan plan(search_metadata().cardinality(), PAGE_SIZE);
+    FanOut::shared().run(channels, [this](const Channel::Ptr &channel) {
         if (DEBUG_MODE) {
             cerr << "  channel: " << channel->id() << " " << channel->title()
                 << endl;
         }
-        playlists_futures.emplace_back(
-                client_.channel_playlists(channel->id()));
-    }
-
-    for (auto &it : playlists_futures) {
-        Client::PlaylistList playlists = it.get();
+        return client_.channel_playlists(channel->id());
+    }, [this, &reply, &cat, &plan](const Channel::Ptr &, const Client::PlaylistList &playlists) {
         for (auto &playlist : playlists) {
             if (DEBUG_MODE) {
                 cerr << "    playlist: " << playlist->id() << " "
                         << playlist->title() << endl;
             }
             push_resource(reply, cat, playlist, my_playlist_);
+            if (!plan.pushed()) {
+                return;
+            }
         }
-    }
+    }, [&plan](size_t outstanding) {
+        return plan.wants(outstanding);
+    });
 
     if (channels.size() == 0) {
         const sc::CannedQuery &query(sc::SearchQueryBase::query());
@@ -678,8 +736,10 @@ void Query::guide_category_playlists(const sc::SearchReplyProxy &reply,
 }
 }
 
-void Query::playlist(const sc::SearchReplyProxy &reply,
+void Query::playlist(const RecordingReply::Ptr &reply,
         const string &playlist_id) {
+    Span span("playlist");
+
     if (DEBUG_MODE) {
         cerr << "Playlist: " << playlist_id << endl;
     }
@@ -690,13 +750,19 @@ void Query::playlist(const sc::SearchReplyProxy &reply,
     auto playlist_future = client_.playlist_items(playlist_id);
     Client::PlaylistItemList items = get_or_throw(playlist_future);
 
+    FetchPlan plan(search_metadata().cardinality(), items.size());
     for (auto &playlist : items) {
         push_resource(reply, cat, playlist, my_playlist_);
+        if (!plan.pushed()) {
+            break;
+        }
     }
 }
 
-void Query::channel(const sc::SearchReplyProxy &reply,
+void Query::channel(const RecordingReply::Ptr &reply,
         const string &channel_id) {
+    Span span("channel");
+
     if (DEBUG_MODE) {
         cerr << "Channel: " << channel_id << endl;
     }
@@ -715,8 +781,12 @@ void Query::channel(const sc::SearchReplyProxy &reply,
 
     auto channels_future = client_.channel_videos(channel_id);
     Client::VideoList videos = get_or_throw(channels_future);
+    FetchPlan plan(search_metadata().cardinality(), videos.size());
     for (auto &video : videos) {
         push_resource(reply, cat, video, my_playlist_);
+        if (!plan.pushed()) {
+            break;
+        }
     }
 
     if (videos.size() == 0) {
@@ -726,14 +796,30 @@ void Query::channel(const sc::SearchReplyProxy &reply,
 }
 }
 
-void Query::popular_videos(const sc::SearchReplyProxy &reply, const std::string &category_id) {
-    auto resources_future = client_.chart_videos("mostPopular", country_code(), category_id);
-    auto resources = get_or_throw(resources_future);
+void Query::popular_videos(const RecordingReply::Ptr &reply, const std::string &category_id) {
+    Span span("popular-videos");
+
+    if (chart_refresher_) {
+        chart_refresher_->requested(country_code(), category_id);
+    }
+
+    ChartCache &chart_cache(ChartCache::instance());
+    Client::VideoList resources;
+    if (!chart_cache.get(ChartCache::key(country_code(), category_id),
+            resources)) {
+        auto resources_future = chart_cache.fetch(client_, country_code(),
+                category_id);
+        resources = get_or_throw(resources_future);
+    }
 
     auto cat = reply->register_category("youtube", _("YouTube"), "",
                                         sc::CategoryRenderer(SEARCH_TEMPLATE));
+    FetchPlan plan(search_metadata().cardinality(), resources.size());
     for (const Resource::Ptr& resource : resources) {
         push_resource(reply, cat, resource, my_playlist_);
+        if (!plan.pushed()) {
+            break;
+        }
     }
 }
 
@@ -749,43 +835,10 @@ string Query::country_code() const {
     return country_code;
 }
 
-void Query::surfacing(const sc::SearchReplyProxy &reply) {
-    const sc::CannedQuery &query(sc::SearchQueryBase::query());
-
-    string raw_department_id = query.department_id();
-
-    bool authenticated = client_.authenticated();
-
-    bool include_login_nag = !authenticated;
-
-    if (!raw_department_id.empty()) {
-        DepartmentPath path(raw_department_id);
-        if (path.department_type == DepartmentType::aggregated) {
-            // Don't include the login nag when we are aggregated
-            include_login_nag = false;
-        }
-    }
-
-    if (include_login_nag) {
-        add_login_nag(reply);
-    }
-
-    if (authenticated) {
-        auto user_future = client_.auth_user_info();
-        auto channels = get_or_throw(user_future);
-        if (channels.size() > 0) {
-            my_playlist_[_("Likes")] = channels[0]->likes_playlist();
-            my_playlist_[_("Favorites")] = channels[0]->favorites_playlist();
-            my_playlist_[_("Watch Later")] = channels[0]->watchLater_playlist();
+DepartmentCache::Tree Query::build_departments(bool authenticated) {
+    Span span("departments");
 
-            if (raw_department_id.empty()) {
-                sc::Category::SCPtr channel_cat = reply->register_category("channel", "", "",
-                        sc::CategoryRenderer(CHANNEL_INFO_TEMPLATE));
-
-                push_channel_info(reply, channel_cat , channels[0]);
-            }
-        }
-    }
+    const sc::CannedQuery &query(sc::SearchQueryBase::query());
 
     sc::Department::SPtr all_depts;
     bool first_dept = true;
@@ -811,9 +864,17 @@ void Query::surfacing(const sc::SearchReplyProxy &reply) {
     std::shared_ptr<GuideCategory> playlist_ptr = std::make_shared<GuideCategory>(playlist_gc);
 
     // get youtube main categories
-    auto departments_future = client_.guide_categories(country_code(),
-            search_metadata().locale());
-    auto departments = get_or_throw(departments_future);
+    Client::GuideCategoryList departments;
+    {
+        Span departments_span("guide-categories");
+        auto departments_future = client_.guide_categories(country_code(),
+                search_metadata().locale());
+        departments = get_or_throw(departments_future);
+    }
+    if (departments.empty()) {
+        // Nothing to hang the tree from, the department queries still work
+        return DepartmentCache::Tree();
+    }
 
     // if logged in, add My Subscriptions and My Playlist department to the list of top level departments
     // in position 1 (so Best of YouTube is position 0)
@@ -903,22 +964,92 @@ void Query::surfacing(const sc::SearchReplyProxy &reply) {
         }
     }
 
+    return DepartmentCache::Tree { all_depts, departments.at(0)->id() };
+}
+
+void Query::surfacing(const RecordingReply::Ptr &reply) {
+    Span span("surfacing");
+
+    const sc::CannedQuery &query(sc::SearchQueryBase::query());
+
+    string raw_department_id = query.department_id();
+
+    if (!raw_department_id.empty()) {
+        DepartmentPath path(raw_department_id);
+        if (path.department_type == DepartmentType::aggregated) {
+            // Another scope wants the chart and nothing else, so there is no
+            // login nag, account or department tree
+            if (path.department == MUSIC_AGGREGATOR_DEPT) {
+                popular_videos(reply, MUSIC_CATEGORY_ID);
+            } else {
+                popular_videos(reply);
+            }
+            return;
+        }
+    }
+
+    bool authenticated = client_.authenticated();
+
+    if (!authenticated) {
+        add_login_nag(reply);
+    }
+
+    string account_id;
+    if (authenticated) {
+        auto user_future = client_.auth_user_info();
+        auto channels = get_or_throw(user_future);
+        if (channels.size() > 0) {
+            account_id = channels[0]->id();
+            my_playlist_[_("Likes")] = channels[0]->likes_playlist();
+            my_playlist_[_("Favorites")] = channels[0]->favorites_playlist();
+            my_playlist_[_("Watch Later")] = channels[0]->watchLater_playlist();
+
+            if (raw_department_id.empty()) {
+                sc::Category::SCPtr channel_cat = reply->register_category("channel", "", "",
+                        sc::CategoryRenderer(CHANNEL_INFO_TEMPLATE));
+
+                push_channel_info(reply, channel_cat , channels[0]);
+            }
+        }
+    }
+
+    // The tree is the same for every department, so is only built when
+    // the region, locale, account or subscriptions change
+    DepartmentCache &department_cache(DepartmentCache::instance());
+    string tree_key = DepartmentCache::key(country_code(),
+            search_metadata().locale(), authenticated, account_id);
+    DepartmentCache::Tree tree;
+    if (!department_cache.get(tree_key, tree)) {
+        unsigned long version = department_cache.version();
+        tree = build_departments(authenticated);
+        if (tree.root) {
+            department_cache.put(tree_key, tree, version);
+        }
+    }
+    sc::Department::SCPtr all_depts = department_cache.bind(tree_key, tree,
+            query);
+    auto register_departments = [&reply, &all_depts]() {
+        if (all_depts) {
+            reply->register_departments(all_depts);
+        }
+    };
+
     if (!raw_department_id.empty()) {
         DepartmentPath path(raw_department_id);
         switch (path.department_type) {
         case DepartmentType::subscriptions: {
-            reply->register_departments(all_depts);
+            register_departments();
             subscriptions(reply);
             break;
         }
         case DepartmentType::subscription: {
-            reply->register_departments(all_depts);
+            register_departments();
             subscription_videos(reply, path.department);
             break;
         }
         case DepartmentType::guide_category: {
             // FIXME Working around the UI bug (have to register departments before results)
-            reply->register_departments(all_depts);
+            register_departments();
 
             switch (path.section_type) {
             case SectionType::none: {
@@ -958,12 +1089,11 @@ void Query::surfacing(const sc::SearchReplyProxy &reply) {
             }
 
             if (!is_user_playlist) {
-            sc::Department::SPtr dummy = sc::Department::create(
-                    raw_department_id, query, " ");
-            all_depts->add_subdepartment(dummy);
+                all_depts = department_cache.bind(tree_key, tree, query,
+                        raw_department_id);
             }
 
-            reply->register_departments(all_depts);
+            register_departments();
             playlist(reply, path.department);
             break;
         }
@@ -971,29 +1101,15 @@ void Query::surfacing(const sc::SearchReplyProxy &reply) {
             // If we click on a channel in the search results
 
             // Need to add a dummy department to pass the validation check
-            sc::Department::SPtr dummy = sc::Department::create(
-                    raw_department_id, query, " ");
-            all_depts->add_subdepartment(dummy);
+            all_depts = department_cache.bind(tree_key, tree, query,
+                    raw_department_id);
 
-            reply->register_departments(all_depts);
+            register_departments();
             channel(reply, path.department);
             break;
         }
         case DepartmentType::aggregated: {
-            // If another scope has asked us to surface results
-
-            // Need to add a dummy department to pass the validation check
-            sc::Department::SPtr dummy = sc::Department::create(
-                    raw_department_id, query, " ");
-            all_depts->add_subdepartment(dummy);
-            reply->register_departments(all_depts);
-
-            if (path.department==MUSIC_AGGREGATOR_DEPT) {
-                popular_videos(reply, MUSIC_CATEGORY_ID);
-            } else {
-                popular_videos(reply);
-            }
-
+            // Served before the departments are built
             break;
         }
         }
@@ -1001,14 +1117,18 @@ void Query::surfacing(const sc::SearchReplyProxy &reply) {
         // This is the initial surfacing screen
 
         // FIXME Working around the UI bug (have to register departments before results)
-        reply->register_departments(all_depts);
+        register_departments();
 
-        guide_category(reply, departments.at(0)->id());
+        if (!tree.first_category_id.empty()) {
+            guide_category(reply, tree.first_category_id);
+        }
     }
     }
 
-void Query::search(const sc::SearchReplyProxy &reply,
+void Query::search(const RecordingReply::Ptr &reply,
         const string &query_string) {
+    Span span("search");
+
     string raw_department_id = sc::SearchQueryBase::query().department_id();
     string category_id;
     // gets the category id if it's being used
@@ -1031,6 +1151,7 @@ void Query::search(const sc::SearchReplyProxy &reply,
     auto resources_future = client_.search(query_string, search_metadata().cardinality(), category_id);
     auto resources = get_or_throw(resources_future);
 
+    Span push_span("push");
     auto cat = reply->register_category("youtube",
             _("1 result from YouTube", "%d results from YouTube",
                     resources->total_results()), "",
@@ -1054,11 +1175,35 @@ void Query::run(sc::SearchReplyProxy const& reply) {
         const sc::CannedQuery &query(sc::SearchQueryBase::query());
         string query_string = alg::trim_copy(query.query_string());
 
+        // Going back to a department, or repeating a search, shows what
+        // it showed last time if that was recent. Subscriptions and the
+        // channel info belong to the account.
+        string key = ResultCache::key(query_string, query.department_id(),
+                country_code(), meta.locale(), client_.authenticated(),
+                client_.account_id(), meta.cardinality());
+        Recording::Ptr cached = ResultCache::instance().get(key);
+        if (cached) {
+            Span span("replay");
+            cached->replay(reply);
+            return;
+        }
+
+        auto recording_reply = make_shared<RecordingReply>(reply);
         if (query_string.empty()) {
-            surfacing(reply);
+            client_.set_priority(Priority::surfacing);
+            surfacing(recording_reply);
         } else {
-            search(reply, query_string);
+            client_.set_priority(Priority::search);
+            search(recording_reply, query_string);
+        }
+
+        if (recording_reply->complete()) {
+            ResultCache::instance().put(key, recording_reply->recording());
         }
+    } catch (Cancelled &e) {
+        // Superseded by a newer query, or the shell stopped taking our
+        // results, so drop whatever is still downloading
+        client_.cancel();
     } catch (domain_error &e) {
         cerr << "ERROR: " << e.what() << endl;
     }
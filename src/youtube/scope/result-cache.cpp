@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <youtube/scope/result-cache.h>
+
+#include <youtube/api/environment.h>
+
+#include <unity/scopes/SearchReply.h>
+
+#include <algorithm>
+
+namespace sc = unity::scopes;
+
+using namespace std;
+using namespace youtube::api;
+using namespace youtube::scope;
+
+void Recording::register_departments(const sc::Department::SCPtr &parent) {
+    steps_.emplace_back([parent](const sc::SearchReplyProxy &reply, Categories &) {
+        reply->register_departments(parent);
+        return true;
+    });
+}
+
+void Recording::register_category(const string &id, const string &title,
+        const string &icon, const sc::CategoryRenderer &renderer) {
+    steps_.emplace_back([id, title, icon, renderer](
+            const sc::SearchReplyProxy &reply, Categories &categories) {
+        categories[id] = reply->register_category(id, title, icon, renderer);
+        return true;
+    });
+}
+
+void Recording::push(const sc::CategorisedResult &result) {
+    string category_id = result.category()->id();
+    steps_.emplace_back([result, category_id](
+            const sc::SearchReplyProxy &reply, Categories &categories) {
+        // Results must belong to a category registered with this reply
+        sc::CategorisedResult replayed(result);
+        replayed.set_category(categories.at(category_id));
+        return reply->push(replayed);
+    });
+}
+
+bool Recording::replay(const sc::SearchReplyProxy &reply) const {
+    Categories categories;
+    for (const Step &step : steps_) {
+        if (!step(reply, categories)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t Recording::size() const {
+    return steps_.size();
+}
+
+RecordingReply::RecordingReply(const sc::SearchReplyProxy &reply) :
+        reply_(reply), recording_(make_shared<Recording>()) {
+}
+
+void RecordingReply::register_departments(const sc::Department::SCPtr &parent) {
+    reply_->register_departments(parent);
+    recording_->register_departments(parent);
+}
+
+sc::Category::SCPtr RecordingReply::register_category(const string &id,
+        const string &title, const string &icon,
+        const sc::CategoryRenderer &renderer) {
+    auto category = reply_->register_category(id, title, icon, renderer);
+    recording_->register_category(id, title, icon, renderer);
+    return category;
+}
+
+bool RecordingReply::push(const sc::CategorisedResult &result) {
+    if (!reply_->push(result)) {
+        complete_ = false;
+        return false;
+    }
+    recording_->push(result);
+    return true;
+}
+
+void RecordingReply::info(const sc::OperationInfo &operation_info) {
+    reply_->info(operation_info);
+    complete_ = false;
+}
+
+bool RecordingReply::complete() const {
+    return complete_;
+}
+
+Recording::Ptr RecordingReply::recording() const {
+    return recording_;
+}
+
+ResultCache::ResultCache(size_t capacity, const Clock::duration &ttl) :
+        capacity_(capacity), ttl_(ttl) {
+}
+
+string ResultCache::key(const string &query_string,
+        const string &department_id, const string &region,
+        const string &locale, bool authenticated, const string &account_id,
+        int cardinality) {
+    // None of the parts contain a unit separator
+    static const char SEPARATOR = '\x1f';
+
+    string key;
+    key.reserve(query_string.size() + department_id.size() + region.size()
+            + locale.size() + account_id.size() + 16);
+    key += query_string;
+    key += SEPARATOR;
+    key += department_id;
+    key += SEPARATOR;
+    key += region;
+    key += SEPARATOR;
+    key += locale;
+    key += SEPARATOR;
+    key += authenticated ? '1' : '0';
+    key += SEPARATOR;
+    key += account_id;
+    key += SEPARATOR;
+    key += to_string(cardinality);
+    return key;
+}
+
+Recording::Ptr ResultCache::get(const string &key) {
+    lock_guard<mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        return nullptr;
+    }
+
+    auto now = Clock::now();
+    if (now - it->second.stored > ttl_) {
+        entries_.erase(it);
+        return nullptr;
+    }
+    it->second.used = now;
+    return it->second.recording;
+}
+
+void ResultCache::put(const string &key, const Recording::Ptr &recording) {
+    if (capacity_ == 0) {
+        return;
+    }
+
+    lock_guard<mutex> lock(mutex_);
+    auto now = Clock::now();
+    if (entries_.size() >= capacity_ && entries_.find(key) == entries_.end()) {
+        auto oldest = min_element(entries_.begin(), entries_.end(),
+                [](const pair<const string, Entry> &a,
+                        const pair<const string, Entry> &b) {
+                    return a.second.used < b.second.used;
+                });
+        entries_.erase(oldest);
+    }
+    entries_[key] = Entry { recording, now, now };
+}
+
+void ResultCache::clear() {
+    lock_guard<mutex> lock(mutex_);
+    entries_.clear();
+}
+
+ResultCache & ResultCache::instance() {
+    static ResultCache cache(
+            env_whole("YOUTUBE_SCOPE_RESULT_CACHE_SIZE", 32),
+            chrono::seconds(env_whole("YOUTUBE_SCOPE_RESULT_CACHE_TTL", 300)));
+    return cache;
+}
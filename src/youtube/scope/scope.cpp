@@ -17,12 +17,19 @@
  *         Gary Wang  <gary.wang@canonical.com>
  */
 
+#include <youtube/api/client.h>
+#include <youtube/api/trace.h>
+#include <youtube/api/uploads-cache.h>
+#include <youtube/scope/chart-refresher.h>
 #include <youtube/scope/localisation.h>
 #include <youtube/scope/scope.h>
+#include <youtube/scope/subscription-index.h>
 #include <youtube/scope/query.h>
 #include <youtube/scope/preview.h>
 #include <youtube/scope/activation.h>
 
+#include <iostream>
+
 namespace sc = unity::scopes;
 using namespace std;
 using namespace youtube::scope;
@@ -39,19 +46,48 @@ void Scope::start(string const&) {
                 new sc::OnlineAccountClient(SCOPE_INSTALL_NAME,
                         "sharing", "google"));
     }
+
+    // Aggregating scopes want charts quickly, so have the default region's
+    // ready before the first one asks
+    auto charts_client = make_shared<Client>(oa_client_);
+    charts_client->set_priority(Priority::background);
+    chart_refresher_ = ChartRefresher::create(charts_client);
+    chart_refresher_->warm("US");
+
+    // Uploads playlists never change, so keep them between runs
+    try {
+        UploadsCache::instance().persist(cache_directory() + "/uploads.json");
+    } catch (exception &e) {
+        cerr << "Not persisting uploads playlists: " << e.what() << endl;
+    }
+
+    auto subscriptions_client = make_shared<Client>(oa_client_);
+    subscriptions_client->set_priority(Priority::background);
+    subscription_index_ = SubscriptionIndex::create(subscriptions_client);
+    subscription_index_->reconcile();
 }
 
 void Scope::stop() {
+    chart_refresher_.reset();
+    subscription_index_.reset();
+    UploadsCache::instance().save();
+
+    if (getenv("YOUTUBE_SCOPE_DUMP_METRICS")) {
+        Client(oa_client_).dump_metrics(cerr);
+    }
+    Tracer::instance().flush();
 }
 
 sc::SearchQueryBase::UPtr Scope::search(const sc::CannedQuery &query,
         const sc::SearchMetadata &metadata) {
-    return sc::SearchQueryBase::UPtr(new Query(query, metadata, oa_client_));
+    return sc::SearchQueryBase::UPtr(new Query(query, metadata, oa_client_,
+            chart_refresher_));
 }
 
 sc::PreviewQueryBase::UPtr Scope::preview(sc::Result const& result,
         sc::ActionMetadata const& metadata) {
-    return sc::PreviewQueryBase::UPtr(new Preview(result, metadata, oa_client_));
+    return sc::PreviewQueryBase::UPtr(new Preview(result, metadata, oa_client_,
+            subscription_index_));
 }
 
 sc::ActivationQueryBase::UPtr Scope::perform_action(const sc::Result &result,
@@ -59,7 +95,7 @@ sc::ActivationQueryBase::UPtr Scope::perform_action(const sc::Result &result,
                                                     const std::string &widget_id,
                                                     const std::string &action_id) {
     return sc::ActivationQueryBase::UPtr(new Activation(result, metadata, action_id,
-                                                        oa_client_));
+                                                        oa_client_, subscription_index_));
 }
 
 #define EXPORT __attribute__ ((visibility ("default")))
@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <youtube/scope/subscription-index.h>
+
+#include <youtube/api/environment.h>
+#include <youtube/api/timer.h>
+#include <youtube/api/uploads-cache.h>
+#include <youtube/api/worker-pool.h>
+
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+using namespace youtube::api;
+using namespace youtube::scope;
+
+SubscriptionIndex::SubscriptionIndex(shared_ptr<Client> client,
+        const Clock::duration &ttl) :
+        client_(client), ttl_(ttl) {
+}
+
+bool SubscriptionIndex::lookup(const string &channel_id,
+        string &subscription_id) {
+    // Cached by the client, so cheap to ask every time
+    string account_id = client_->account_id();
+
+    bool stale;
+    {
+        lock_guard<mutex> lock(mutex_);
+        if (loaded_ && account_id != account_id_) {
+            // Someone else signed in, none of this is theirs
+            ++version_;
+            subscriptions_.clear();
+            loaded_ = false;
+        }
+        stale = !loaded_ || Clock::now() - loaded_at_ > ttl_;
+        if (loaded_) {
+            auto it = subscriptions_.find(channel_id);
+            subscription_id = it == subscriptions_.end() ? "" : it->second;
+        }
+    }
+
+    // An old answer is still better than waiting on the server
+    if (stale) {
+        reconcile();
+    }
+
+    lock_guard<mutex> lock(mutex_);
+    return loaded_;
+}
+
+void SubscriptionIndex::subscribed(const string &channel_id,
+        const string &subscription_id) {
+    lock_guard<mutex> lock(mutex_);
+    ++version_;
+    if (subscription_id.empty()) {
+        // Without the id the preview could not offer to unsubscribe, so
+        // leave it to the server until the next reconcile
+        loaded_ = false;
+        return;
+    }
+    subscriptions_[channel_id] = subscription_id;
+}
+
+void SubscriptionIndex::unsubscribed(const string &subscription_id) {
+    lock_guard<mutex> lock(mutex_);
+    ++version_;
+    for (auto it = subscriptions_.begin(); it != subscriptions_.end(); ++it) {
+        if (it->second == subscription_id) {
+            subscriptions_.erase(it);
+            return;
+        }
+    }
+}
+
+void SubscriptionIndex::reconcile() {
+    schedule();
+
+    if (!client_->authenticated()) {
+        // Whoever was logged in before, these are not ours any more
+        clear();
+        return;
+    }
+
+    string account_id = client_->account_id();
+    unsigned long started_version;
+    {
+        lock_guard<mutex> lock(mutex_);
+        if (reconciling_) {
+            return;
+        }
+        reconciling_ = true;
+        started_version = version_;
+    }
+
+    // The client cancels its requests when the index goes away, so the
+    // callbacks must not keep it alive or assume it is still there
+    weak_ptr<SubscriptionIndex> weak(shared_from_this());
+    client_->all_subscription_channels().then(
+            [weak, started_version, account_id](const Client::SubscriptionList &subscriptions) {
+                auto index = weak.lock();
+                if (index) {
+                    index->load(subscriptions, started_version, account_id);
+                    index->prefetch_uploads(subscriptions);
+                }
+                return true;
+            }).finally([weak]() {
+                auto index = weak.lock();
+                if (index) {
+                    lock_guard<mutex> lock(index->mutex_);
+                    index->reconciling_ = false;
+                }
+            });
+}
+
+void SubscriptionIndex::schedule() {
+    {
+        lock_guard<mutex> lock(mutex_);
+        if (scheduled_) {
+            return;
+        }
+        scheduled_ = true;
+    }
+
+    // However short the TTL, the server is not asked over and over
+    auto delay = max(ttl_, Clock::duration(chrono::minutes(1)));
+    weak_ptr<SubscriptionIndex> weak(shared_from_this());
+    Timer::instance().schedule(delay, [weak]() {
+        WorkerPool::background().post([weak]() {
+            auto index = weak.lock();
+            if (index) {
+                {
+                    lock_guard<mutex> lock(index->mutex_);
+                    index->scheduled_ = false;
+                }
+                index->reconcile();
+            }
+        });
+    });
+}
+
+void SubscriptionIndex::prefetch_uploads(
+        const Client::SubscriptionList &subscriptions) {
+    // Opening a subscription then only costs its playlist items
+    vector<string> channel_ids;
+    for (const auto &subscription : subscriptions) {
+        channel_ids.emplace_back(subscription->id());
+    }
+    client_->prefetch_uploads(channel_ids).finally([]() {
+        // Once per reconcile, and off the parser pool and the timer
+        WorkerPool::background().post([]() {
+            UploadsCache::instance().save();
+        });
+    });
+}
+
+void SubscriptionIndex::load(const Client::SubscriptionList &subscriptions,
+        unsigned long version, const string &account_id) {
+    lock_guard<mutex> lock(mutex_);
+    if (version != version_) {
+        // Someone subscribed or unsubscribed while this was being fetched
+        return;
+    }
+    subscriptions_.clear();
+    for (const auto &subscription : subscriptions) {
+        subscriptions_[subscription->id()] = subscription->subscribeId();
+    }
+    loaded_ = true;
+    loaded_at_ = Clock::now();
+    account_id_ = account_id;
+}
+
+unsigned long SubscriptionIndex::version() {
+    lock_guard<mutex> lock(mutex_);
+    return version_;
+}
+
+void SubscriptionIndex::clear() {
+    lock_guard<mutex> lock(mutex_);
+    ++version_;
+    subscriptions_.clear();
+    loaded_ = false;
+}
+
+SubscriptionIndex::Ptr SubscriptionIndex::create(shared_ptr<Client> client) {
+    return make_shared<SubscriptionIndex>(client,
+            chrono::seconds(
+                    env_whole("YOUTUBE_SCOPE_SUBSCRIPTION_INDEX_TTL", 600)));
+}
@@ -0,0 +1,247 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "../benchmark-report.h"
+
+#include <allocation-counter.h>
+
+#include <youtube/api/channel.h>
+#include <youtube/api/channel-section.h>
+#include <youtube/api/comment.h>
+#include <youtube/api/guide-category.h>
+#include <youtube/api/playlist.h>
+#include <youtube/api/playlist-item.h>
+#include <youtube/api/search-list-response.h>
+#include <youtube/api/subscription.h>
+#include <youtube/api/subscription-item.h>
+#include <youtube/api/typed-list.h>
+#include <youtube/api/video.h>
+
+#include <gtest/gtest.h>
+#include <json/json.h>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+using namespace youtube;
+using namespace youtube::api;
+
+namespace {
+
+typedef chrono::steady_clock Clock;
+
+typedef chrono::duration<double> Seconds;
+
+/*
+ * Builds the models from a parsed response, and returns how many there are
+ */
+typedef function<size_t(const Json::Value &root)> ParseItems;
+
+Json::Value load(const string &path) {
+    ifstream in(string(FAKE_YOUTUBE_FIXTURES) + "/" + path);
+    Json::Reader reader;
+    Json::Value root;
+    if (!reader.parse(in, root)) {
+        throw domain_error("Could not parse fixture " + path);
+    }
+    return root;
+}
+
+/*
+ * A list response holding just the given item
+ */
+Json::Value synthetic(const string &kind, const Json::Value &item) {
+    Json::Value root;
+    root["kind"] = kind;
+    root["items"].append(item);
+    return root;
+}
+
+/*
+ * Repeats the items of a response until there are count of them
+ */
+Json::Value scale(const Json::Value &response, unsigned int count) {
+    const Json::Value &items = response["items"];
+
+    Json::Value scaled(response);
+    Json::Value &scaled_items = scaled["items"] = Json::Value(Json::arrayValue);
+    for (unsigned int i = 0; i < count; ++i) {
+        scaled_items.append(items[i % items.size()]);
+    }
+    scaled["pageInfo"]["totalResults"] = count;
+    scaled["pageInfo"]["resultsPerPage"] = count;
+    return scaled;
+}
+
+class BenchmarkParsing: public testing::Test {
+protected:
+    struct Result {
+        double items_per_second;
+
+        double allocations_per_item;
+    };
+
+    /*
+     * Repeats f until it has run for long enough to time, and returns
+     * the throughput and allocations of one run
+     */
+    static Result time(size_t items, const function<size_t()> &f) {
+        static const Seconds MIN_DURATION(0.2);
+        static const unsigned int MIN_RUNS = 3;
+
+        unsigned int runs = 0;
+        unsigned long allocations = 0;
+        Clock::duration elapsed = Clock::duration::zero();
+        while (runs < MIN_RUNS || elapsed < MIN_DURATION) {
+            CountAllocations counter;
+            auto start = Clock::now();
+            size_t parsed = f();
+            elapsed += Clock::now() - start;
+            allocations += counter.count();
+            ++runs;
+
+            EXPECT_EQ(items, parsed);
+        }
+
+        Result result;
+        result.items_per_second = items * runs / Seconds(elapsed).count();
+        result.allocations_per_item = double(allocations) / (items * runs);
+        return result;
+    }
+
+    /*
+     * Parses the fixture as is, then scaled up to 1k and 10k items,
+     * timing the JSON parse and the construction of the models separately
+     */
+    void measure(const string &type, const Json::Value &fixture,
+            const ParseItems &parse) {
+        for (unsigned int count : { fixture["items"].size(), 1000u, 10000u }) {
+            Json::Value root = scale(fixture, count);
+            string text = Json::FastWriter().write(root);
+
+            Result json = time(count, [&text]() {
+                Json::Reader reader;
+                Json::Value parsed;
+                reader.parse(text, parsed);
+                return parsed["items"].size();
+            });
+            Result models = time(count, [&root, &parse]() {
+                return parse(root);
+            });
+
+            Json::Value record;
+            record["benchmark"] = "parse";
+            record["type"] = type;
+            record["items"] = count;
+            record["bytes_per_item"] = double(text.size()) / count;
+            record["json"]["items_per_second"] = json.items_per_second;
+            record["json"]["allocations_per_item"] = json.allocations_per_item;
+            record["models"]["items_per_second"] = models.items_per_second;
+            record["models"]["allocations_per_item"] = models.allocations_per_item;
+            report_benchmark(record);
+        }
+    }
+
+    template<typename T>
+    void measure_list(const string &type, const string &kind,
+            const Json::Value &fixture) {
+        measure(type, fixture, [kind](const Json::Value &root) {
+            return get_typed_list<T>(kind, root).size();
+        });
+    }
+};
+
+TEST_F(BenchmarkParsing, video) {
+    measure_list<Video>("Video", "youtube#video",
+            load("videos/videoCategoryId/10.json"));
+}
+
+TEST_F(BenchmarkParsing, channel) {
+    measure_list<Channel>("Channel", "youtube#channel",
+            load("channels/GCTXVzaWM.json"));
+}
+
+TEST_F(BenchmarkParsing, playlist) {
+    measure_list<Playlist>("Playlist", "youtube#playlist",
+            load("playlists/UC20vb-R_px4CguHzzBPhoyQ.json"));
+}
+
+TEST_F(BenchmarkParsing, playlist_item) {
+    measure_list<PlaylistItem>("PlaylistItem", "youtube#playlistItem",
+            load("playlistItems/PLEE58C6029A8A6ADE.json"));
+}
+
+TEST_F(BenchmarkParsing, channel_section) {
+    measure_list<ChannelSection>("ChannelSection", "youtube#channelSection",
+            load("channelSections/UC20vb-R_px4CguHzzBPhoyQ.json"));
+}
+
+TEST_F(BenchmarkParsing, guide_category) {
+    measure_list<GuideCategory>("GuideCategory", "youtube#guideCategory",
+            load("guide-categories.json"));
+}
+
+TEST_F(BenchmarkParsing, subscription_item) {
+    // Subscription uploads are read from playlistItems like any playlist
+    measure_list<SubscriptionItem>("SubscriptionItem", "youtube#playlistItem",
+            load("playlistItems/UU20vb-R_px4CguHzzBPhoyQ.json"));
+}
+
+TEST_F(BenchmarkParsing, subscription) {
+    // The fake server has no subscriptions, they need an account
+    Json::Value item;
+    item["kind"] = "youtube#subscription";
+    item["id"] = "5nzJ7yDqeWcLGGX3UlAC_2OfFxydD3TyXRGD8HN2ggg";
+    item["snippet"]["title"] = "Google Developers";
+    item["snippet"]["resourceId"]["kind"] = "youtube#channel";
+    item["snippet"]["resourceId"]["channelId"] = "UC_x5XG1OV2P6uZZ5FSM9Ttw";
+    item["snippet"]["thumbnails"]["default"]["url"] =
+            "https://yt3.ggpht.com/-Fgp8KFpgQqE/AAAAAAAAAAI/AAAAAAAAAAA/Wyh1vV5Up0I/s88-c-k-no/photo.jpg";
+
+    measure_list<Subscription>("Subscription", "youtube#subscription",
+            synthetic("youtube#subscriptionListResponse", item));
+}
+
+TEST_F(BenchmarkParsing, comment) {
+    // Nor comments
+    Json::Value item;
+    item["kind"] = "youtube#commentThread";
+    item["id"] = "z13icrq45mzjfvkpv04ce54gbnjgvroojf0";
+    Json::Value &comment = item["snippet"]["topLevelComment"];
+    comment["publishedAt"] = "2014-10-02T11:29:14.000Z";
+    comment["snippet"]["textDisplay"] =
+            "Great video, I have watched it many times over and over again.";
+    comment["snippet"]["authorDisplayName"] = "Joe Bloggs";
+    comment["snippet"]["authorChannelId"]["value"] = "UCWRdAVHhAjydP3yScRXhWUw";
+    comment["snippet"]["authorProfileImageUrl"] =
+            "https://lh3.googleusercontent.com/-XdUIqdMkCWA/AAAAAAAAAAI/AAAAAAAAAAA/4252rscbv5M/photo.jpg";
+
+    measure_list<Comment>("Comment", "youtube#commentThread",
+            synthetic("youtube#commentThreadListResponse", item));
+}
+
+TEST_F(BenchmarkParsing, search_list_response) {
+    measure("SearchListResponse", load("search/q/banana.json"),
+            [](const Json::Value &root) {
+                return SearchListResponse(root).items().size();
+            });
+}
+
+} // namespace
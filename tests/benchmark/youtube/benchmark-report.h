@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef YOUTUBE_BENCHMARK_REPORT_H_
+#define YOUTUBE_BENCHMARK_REPORT_H_
+
+#include <json/json.h>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+
+namespace youtube {
+
+/**
+ * Prints a benchmark result, and appends it as one JSON object per line
+ * to the file named by YOUTUBE_SCOPE_BENCHMARK_OUTPUT, by default
+ * benchmark-results.jsonl in the working directory, for CI to compare
+ * against earlier runs. The file is truncated once per process.
+ */
+inline void report_benchmark(const Json::Value &record) {
+    static std::mutex output_mutex;
+    static std::ofstream output(
+            getenv("YOUTUBE_SCOPE_BENCHMARK_OUTPUT") ?
+                    getenv("YOUTUBE_SCOPE_BENCHMARK_OUTPUT") :
+                    "benchmark-results.jsonl", std::ios::trunc);
+
+    Json::FastWriter writer;
+    std::string line = writer.write(record);
+
+    std::lock_guard<std::mutex> lock(output_mutex);
+    std::cout << line;
+    output << line;
+    output.flush();
+}
+
+}
+
+#endif // YOUTUBE_BENCHMARK_REPORT_H_
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "scope-benchmark.h"
+
+#include <youtube/api/client.h>
+#include <youtube/scope/fan-out.h>
+
+using namespace std;
+using namespace youtube::scope;
+
+namespace {
+
+class BenchmarkFanOut: public ScopeBenchmark {
+protected:
+    void sweep(const string &department_id) {
+        static const unsigned int ITERATIONS = 20;
+
+        for (unsigned int width : { 1, 2, 4, 8, 16 }) {
+            FanOut::shared().pin(width);
+
+            // Warm up the uploads playlist cache and the connections
+            run_query("", department_id);
+
+            vector<Millis> latencies;
+            for (unsigned int i = 0; i < ITERATIONS; ++i) {
+                latencies.emplace_back(run_query("", department_id));
+            }
+
+            Json::Value record;
+            record["benchmark"] = "fan_out";
+            record["department"] = department_id;
+            record["width"] = width;
+            record["latency_ms"] = summarise(latencies);
+            report(record);
+        }
+
+        // The parse stage is shared by every client in the process
+        auto stats = youtube::api::Client(nullptr).parse_stats();
+        unsigned long completed = max(1ul, stats.completed);
+
+        Json::Value record;
+        record["benchmark"] = "parse_stage";
+        record["department"] = department_id;
+        record["parsed"] = Json::Value::UInt64(stats.completed);
+        record["peak_queued"] = Json::Value::UInt64(stats.peak_queued);
+        record["mean_wait_ms"] = Millis(stats.waiting).count() / completed;
+        record["mean_parse_ms"] = Millis(stats.running).count() / completed;
+        report(record);
+    }
+};
+
+TEST_F(BenchmarkFanOut, guide_category) {
+    sweep("guideCategory:GCTXVzaWM");
+}
+
+TEST_F(BenchmarkFanOut, guide_category_videos) {
+    sweep("guideCategory-videos:GCTXVzaWM");
+}
+
+TEST_F(BenchmarkFanOut, guide_category_playlists) {
+    sweep("guideCategory-playlists:GCTXVzaWM");
+}
+
+} // namespace
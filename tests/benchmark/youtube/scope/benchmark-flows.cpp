@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "scope-benchmark.h"
+
+using namespace std;
+using namespace youtube::scope;
+
+namespace {
+
+class BenchmarkFlows: public ScopeBenchmark {
+protected:
+    /*
+     * End to end latency and throughput of one flow, at increasing
+     * numbers of concurrent queries
+     */
+    void measure(const string &flow, const string &query_string,
+            const string &department_id) {
+        static const unsigned int ITERATIONS = 10;
+
+        // Warm up the caches and the connections
+        run_query(query_string, department_id);
+
+        for (unsigned int concurrency : { 1, 4, 8 }) {
+            Millis wall;
+            auto latencies = run_concurrent(query_string, department_id,
+                    concurrency, ITERATIONS, wall);
+
+            Json::Value record;
+            record["benchmark"] = "flow";
+            record["flow"] = flow;
+            record["concurrency"] = concurrency;
+            record["queries"] = Json::Value::UInt(latencies.size());
+            record["wall_ms"] = wall.count();
+            record["throughput_qps"] = latencies.size() / (wall.count() / 1000.0);
+            record["latency_ms"] = summarise(latencies);
+            report(record);
+        }
+    }
+};
+
+/*
+ * The same flows against a server that behaves more like the real one:
+ * a long tail of slow responses, and the occasional error or reset
+ */
+class BenchmarkFlowsUnderLatency: public BenchmarkFlows {
+protected:
+    string faults() override {
+        return R"({"seed": 1,
+                   "default": {"latency_ms": {"distribution": "lognormal",
+                                              "median": 40, "sigma": 0.6},
+                               "error_rate": 0.01, "drop_rate": 0.005},
+                   "endpoints": {"search": {"drip_bytes": 1024,
+                                            "drip_interval_ms": 5}}})";
+    }
+};
+
+/*
+ * Repeats of the same query, as when going back to a department, which
+ * are answered from the result cache
+ */
+class BenchmarkFlowsCached: public BenchmarkFlows {
+protected:
+    void SetUp() override
+    {
+        BenchmarkFlows::SetUp();
+        cache_results_ = true;
+    }
+};
+
+TEST_F(BenchmarkFlows, non_empty_query) {
+    measure("non_empty_query", "banana", "");
+}
+
+TEST_F(BenchmarkFlows, basic_surfacing) {
+    measure("basic_surfacing", "", "");
+}
+
+TEST_F(BenchmarkFlows, pick_department) {
+    measure("pick_department", "", "guideCategory:GCTXVzaWM");
+}
+
+TEST_F(BenchmarkFlows, pick_department_channels) {
+    measure("pick_department_channels", "", "guideCategory-channels:GCTXVzaWM");
+}
+
+TEST_F(BenchmarkFlows, pick_department_videos) {
+    measure("pick_department_videos", "", "guideCategory-videos:GCTXVzaWM");
+}
+
+TEST_F(BenchmarkFlows, pick_department_playlists) {
+    measure("pick_department_playlists", "", "guideCategory-playlists:GCTXVzaWM");
+}
+
+TEST_F(BenchmarkFlows, surface_music) {
+    measure("surface_music", "", "aggregated:musicaggregator");
+}
+
+TEST_F(BenchmarkFlows, search_music) {
+    measure("search_music", "Metallica", "aggregated:musicaggregator");
+}
+
+TEST_F(BenchmarkFlowsCached, non_empty_query) {
+    measure("non_empty_query_cached", "banana", "");
+}
+
+TEST_F(BenchmarkFlowsCached, pick_department) {
+    measure("pick_department_cached", "", "guideCategory:GCTXVzaWM");
+}
+
+TEST_F(BenchmarkFlowsUnderLatency, non_empty_query) {
+    measure("non_empty_query_under_latency", "banana", "");
+}
+
+TEST_F(BenchmarkFlowsUnderLatency, pick_department) {
+    measure("pick_department_under_latency", "", "guideCategory:GCTXVzaWM");
+}
+
+} // namespace
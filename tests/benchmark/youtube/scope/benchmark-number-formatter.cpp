@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "../benchmark-report.h"
+
+#include <youtube/scope/number-formatter.h>
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <functional>
+#include <sstream>
+#include <string>
+
+using namespace std;
+using namespace youtube;
+using namespace youtube::scope;
+
+namespace {
+
+typedef chrono::steady_clock Clock;
+
+typedef chrono::duration<double, nano> Nanos;
+
+/*
+ * How format_fixed used to work, building the locale for every number
+ */
+string format_imbued(long long number) {
+    string n = to_string(number);
+    stringstream ss;
+    ss.imbue(locale(""));
+    ss << fixed << stoll(n);
+    return ss.str();
+}
+
+Nanos per_call(const function<string(long long)> &format) {
+    static const unsigned int CALLS = 100000;
+
+    size_t length = 0;
+    auto start = Clock::now();
+    for (unsigned int i = 0; i < CALLS; ++i) {
+        length += format(1234567ll * i).size();
+    }
+    Nanos elapsed = Clock::now() - start;
+    EXPECT_GT(length, 0ul);
+    return elapsed / CALLS;
+}
+
+TEST(BenchmarkNumberFormatter, format_fixed) {
+    Json::Value record;
+    record["benchmark"] = "number_format";
+    record["imbued_ns"] = per_call(format_imbued).count();
+    record["cached_ns"] = per_call(format_fixed).count();
+    report_benchmark(record);
+}
+
+} // namespace
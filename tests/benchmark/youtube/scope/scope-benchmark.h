@@ -0,0 +1,216 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef YOUTUBE_SCOPE_BENCHMARK_H_
+#define YOUTUBE_SCOPE_BENCHMARK_H_
+
+#include "../benchmark-report.h"
+
+#include <youtube/api/client.h>
+#include <youtube/scope/result-cache.h>
+#include <youtube/scope/scope.h>
+
+#include <core/posix/exec.h>
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <json/json.h>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unity/scopes/SearchReply.h>
+#include <unity/scopes/SearchReplyProxyFwd.h>
+#include <unity/scopes/testing/Category.h>
+#include <unity/scopes/testing/MockSearchReply.h>
+#include <unity/scopes/testing/TypedScopeFixture.h>
+
+namespace youtube {
+namespace scope {
+
+/**
+ * Runs the scope against the fake YouTube server and reports timings,
+ * see report_benchmark().
+ */
+class ScopeBenchmark: public unity::scopes::testing::TypedScopeFixture<Scope> {
+protected:
+    typedef std::chrono::duration<double, std::milli> Millis;
+
+    /*
+     * Fault injection settings for the fake server, see Faults in
+     * server.py. Defaults to YOUTUBE_SCOPE_BENCHMARK_FAULTS.
+     */
+    virtual std::string faults() {
+        const char *faults = getenv("YOUTUBE_SCOPE_BENCHMARK_FAULTS");
+        return faults ? faults : "";
+    }
+
+    void SetUp() override
+    {
+        std::vector<std::string> arguments;
+        std::string config = faults();
+        if (!config.empty()) {
+            arguments.emplace_back("--faults=" + config);
+        }
+
+        fake_youtube_server_ = core::posix::exec(FAKE_YOUTUBE_SERVER,
+                arguments, { }, core::posix::StandardStream::stdout);
+
+        ASSERT_GT(fake_youtube_server_.pid(), 0);
+        std::string port;
+        fake_youtube_server_.cout() >> port;
+
+        std::string apiroot = "http://127.0.0.1:" + port;
+        setenv("YOUTUBE_SCOPE_APIROOT", apiroot.c_str(), true);
+
+        setenv("YOUTUBE_SCOPE_IGNORE_ACCOUNTS", "true", true);
+
+        // The real rate limit would soon have us timing the quota rather
+        // than the scope. This must happen before the first client.
+        setenv("YOUTUBE_SCOPE_QUOTA_BUDGET", "1e15", true);
+        setenv("YOUTUBE_SCOPE_QUOTA_BURST", "1e12", true);
+        setenv("YOUTUBE_SCOPE_QUOTA_REFILL", "1e12", true);
+
+        TypedScopeFixture::set_scope_directory(TEST_SCOPE_DIRECTORY);
+        TypedScopeFixture::SetUp();
+
+        failures_ = failed_requests();
+    }
+
+    void TearDown() override
+    {
+        // A failed query returns early, so its timing would flatter us.
+        // Only injected faults are allowed to fail requests.
+        if (faults().empty()) {
+            EXPECT_EQ(failures_, failed_requests())
+                    << "Requests failed during the benchmark";
+        }
+        TypedScopeFixture::TearDown();
+    }
+
+    /*
+     * Requests that failed or were refused, over every client in the
+     * process
+     */
+    static unsigned long failed_requests() {
+        unsigned long errors = 0;
+        for (const auto &endpoint : youtube::api::Client(nullptr).metrics()) {
+            errors += endpoint.second.errors;
+        }
+        return errors;
+    }
+
+    Millis run_query(const std::string &query_string,
+            const std::string &department_id) {
+        namespace sc = unity::scopes;
+        namespace sct = unity::scopes::testing;
+        using namespace testing;
+
+        NiceMock<sct::MockSearchReply> reply;
+        ON_CALL(reply, register_category(_, _, _, _)).WillByDefault(
+                Invoke([](const std::string &id, const std::string &title,
+                        const std::string &icon, const sc::CategoryRenderer &renderer) {
+                    return std::make_shared<sct::Category>(id, title, icon, renderer);
+                }));
+        ON_CALL(reply, push(Matcher<sc::CategorisedResult const&>(_))).WillByDefault(
+                Return(true));
+
+        sc::SearchReplyProxy reply_proxy(&reply, [](sc::SearchReply*) {});
+        sc::CannedQuery query(SCOPE_NAME, query_string, department_id);
+        sc::SearchMetadata meta_data("en_EN", "phone");
+
+        if (!cache_results_) {
+            ResultCache::instance().clear();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        auto search_query = scope->search(query, meta_data);
+        search_query->run(reply_proxy);
+        return std::chrono::steady_clock::now() - start;
+    }
+
+    /*
+     * Runs the query iterations times on each of concurrency threads,
+     * and returns every latency along with the wall clock time taken
+     */
+    std::vector<Millis> run_concurrent(const std::string &query_string,
+            const std::string &department_id, unsigned int concurrency,
+            unsigned int iterations, Millis &wall) {
+        std::vector<Millis> latencies;
+        std::mutex latencies_mutex;
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (unsigned int t = 0; t < concurrency; ++t) {
+            threads.emplace_back([&]() {
+                for (unsigned int i = 0; i < iterations; ++i) {
+                    Millis latency = run_query(query_string, department_id);
+                    std::lock_guard<std::mutex> lock(latencies_mutex);
+                    latencies.emplace_back(latency);
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        wall = std::chrono::steady_clock::now() - start;
+
+        return latencies;
+    }
+
+    static Json::Value summarise(std::vector<Millis> latencies) {
+        Json::Value summary;
+        if (latencies.empty()) {
+            return summary;
+        }
+        std::sort(latencies.begin(), latencies.end());
+
+        Millis total(0);
+        for (const Millis &latency : latencies) {
+            total += latency;
+        }
+        auto percentile = [&latencies](double fraction) {
+            std::size_t index = std::min(latencies.size() - 1,
+                    static_cast<std::size_t>(fraction * latencies.size()));
+            return latencies[index].count();
+        };
+
+        summary["mean"] = total.count() / latencies.size();
+        summary["p50"] = percentile(0.5);
+        summary["p90"] = percentile(0.9);
+        summary["p99"] = percentile(0.99);
+        summary["max"] = latencies.back().count();
+        return summary;
+    }
+
+    static void report(const Json::Value &record) {
+        report_benchmark(record);
+    }
+
+    // Off by default, so that every query does the full amount of work
+    bool cache_results_ = false;
+
+    unsigned long failures_ = 0;
+
+    core::posix::ChildProcess fake_youtube_server_ =
+            core::posix::ChildProcess::invalid();
+};
+
+}
+}
+
+#endif // YOUTUBE_SCOPE_BENCHMARK_H_
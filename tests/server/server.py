@@ -19,7 +19,11 @@
 
 import base64
 import json
+import math
 import os
+import random
+import time
+import tornado.gen
 import tornado.httpserver
 import tornado.ioloop
 import tornado.netutil
@@ -41,88 +45,276 @@ def read_file(path):
 
 GUIDE_CATEGORIES = read_file('guide-categories.json')
 
+class Faults(object):
+    """
+    Misbehaviour to inject, configured per endpoint with a JSON object such as
+
+      {"seed": 1,
+       "default": {"latency_ms": {"distribution": "uniform", "min": 5, "max": 20}},
+       "endpoints": {"search": {"error_rate": 0.1, "error_status": 503,
+                                "drop_rate": 0.05, "not_modified_rate": 0.1,
+                                "drip_bytes": 256, "drip_interval_ms": 10}}}
+
+    Latency distributions are "fixed" (value), "uniform" (min, max),
+    "exponential" (mean) or "lognormal" (median, sigma), all in milliseconds.
+    Endpoint settings override the default ones.
+    """
+
+    def __init__(self, config):
+        self.random = random.Random(config.get('seed'))
+        self.default = config.get('default', {})
+        self.endpoints = config.get('endpoints', {})
+
+    def settings(self, endpoint):
+        settings = dict(self.default)
+        settings.update(self.endpoints.get(endpoint, {}))
+        return settings
+
+    def latency(self, settings):
+        latency = settings.get('latency_ms')
+        if not latency:
+            return 0.0
+        distribution = latency.get('distribution', 'fixed')
+        if distribution == 'fixed':
+            ms = latency['value']
+        elif distribution == 'uniform':
+            ms = self.random.uniform(latency['min'], latency['max'])
+        elif distribution == 'exponential':
+            ms = self.random.expovariate(1.0 / latency['mean'])
+        elif distribution == 'lognormal':
+            ms = self.random.lognormvariate(math.log(latency['median']), latency['sigma'])
+        else:
+            raise Exception("Unknown latency distribution '%s'" % distribution)
+        return ms / 1000.0
+
+    def happens(self, settings, name):
+        return self.random.random() < settings.get(name, 0.0)
+
+FAULTS = Faults({})
+
+def parse_fields(spec):
+    """
+    Parses a fields= projection such as 'items(id,snippet/title)' into
+    nested dicts, where None selects the whole value
+    """
+    pos = [0]
+
+    def name():
+        start = pos[0]
+        while pos[0] < len(spec) and spec[pos[0]] not in ',/()':
+            pos[0] += 1
+        if pos[0] == start:
+            raise Exception("Bad fields '%s' at %d" % (spec, start))
+        return spec[start:pos[0]]
+
+    def item(tree):
+        key = name()
+        if pos[0] < len(spec) and spec[pos[0]] in '/(':
+            sub = tree.get(key, {})
+            if sub is None:
+                sub = {}
+            if spec[pos[0]] == '/':
+                pos[0] += 1
+                item(sub)
+            else:
+                pos[0] += 1
+                selection(sub)
+                if pos[0] >= len(spec) or spec[pos[0]] != ')':
+                    raise Exception("Unbalanced fields '%s'" % spec)
+                pos[0] += 1
+            if tree.get(key, {}) is not None:
+                tree[key] = sub
+        else:
+            tree[key] = None
+
+    def selection(tree):
+        item(tree)
+        while pos[0] < len(spec) and spec[pos[0]] == ',':
+            pos[0] += 1
+            item(tree)
+
+    tree = {}
+    selection(tree)
+    if pos[0] != len(spec):
+        raise Exception("Unbalanced fields '%s'" % spec)
+    return tree
+
+def project(value, tree):
+    if tree is None:
+        return value
+    if isinstance(value, list):
+        return [project(v, tree) for v in value]
+    if isinstance(value, dict):
+        return dict((k, project(value[k], sub)) for k, sub in tree.items() if k in value)
+    return value
+
+def sleep(seconds):
+    if hasattr(tornado.gen, 'sleep'):
+        return tornado.gen.sleep(seconds)
+    return tornado.gen.Task(tornado.ioloop.IOLoop.current().add_timeout,
+                            time.time() + seconds)
+
 class ErrorHandler(tornado.web.RequestHandler):
     def write_error(self, status_code, **kwargs):
-        self.write(json.dumps({'error': '%s: %d' % (kwargs["exc_info"][1], status_code)}))
+        # Shaped like the real API's errors
+        message = '%s: %d' % (kwargs["exc_info"][1], status_code)
+        self.write(json.dumps({'error': {'code': status_code, 'message': message,
+            'errors': [{'domain': 'global', 'reason': 'backendError', 'message': message}]}}))
 
-class Channels(ErrorHandler):
+class FixtureHandler(ErrorHandler):
+    """
+    Answers with the body() of the subclass, after applying any faults
+    configured for the endpoint. Like the real API, the answer only keeps
+    what the fields= projection asks for, and the scope must always send
+    one.
+    """
+
+    @tornado.gen.coroutine
     def get(self):
-        validate_header(self, 'Accept-Encoding', 'gzip')
-        validate_argument(self, 'part', 'snippet,statistics')
+        settings = FAULTS.settings(self.request.path.split('/')[-1])
+
+        delay = FAULTS.latency(settings)
+        if delay > 0:
+            yield sleep(delay)
 
-        file = 'channels/%s.json' % self.get_argument('categoryId', None)
-        self.write(read_file(file))
+        if FAULTS.happens(settings, 'drop_rate'):
+            stream = getattr(self.request.connection, 'stream', None)
+            (stream or self.request.connection).close()
+            return
+
+        if FAULTS.happens(settings, 'error_rate'):
+            raise tornado.web.HTTPError(settings.get('error_status', 503),
+                                        'Injected failure')
+
+        if FAULTS.happens(settings, 'not_modified_rate'):
+            self.set_status(304)
+            self.finish()
+            return
+
+        fields = parse_fields(self.get_argument('fields', ''))
+        body = self.body()
+        try:
+            body = json.dumps(project(json.loads(body), fields))
+        except ValueError:
+            # Some fixtures are deliberately empty or broken
+            pass
+
+        drip_bytes = settings.get('drip_bytes')
+        if drip_bytes:
+            interval = settings.get('drip_interval_ms', 10) / 1000.0
+            for start in range(0, len(body), drip_bytes):
+                self.write(body[start:start + drip_bytes])
+                flushed = self.flush()
+                if flushed:
+                    yield flushed
+                yield sleep(interval)
+        else:
+            self.write(body)
         self.finish()
 
-class ChannelSections(ErrorHandler):
-    def get(self):
+class Channels(FixtureHandler):
+    def body(self):
+        validate_header(self, 'Accept-Encoding', 'gzip')
+
+        id = self.get_argument('id', None)
+        if id:
+            validate_argument(self, 'part', 'contentDetails')
+            if ',' in id:
+                # Like the real API, unknown channels are just left out
+                items = []
+                for c in id.split(','):
+                    file = 'channels/id/%s.json' % c
+                    if os.path.isfile(os.path.join(os.path.dirname(__file__), file)):
+                        items += json.loads(read_file(file))['items']
+                return json.dumps({'kind': 'youtube#channelListResponse',
+                    'pageInfo': {'totalResults': len(items), 'resultsPerPage': len(items)},
+                    'items': items})
+            file = 'channels/id/%s.json' % id
+        else:
+            validate_argument(self, 'part', 'snippet,statistics')
+            file = 'channels/%s.json' % self.get_argument('categoryId', None)
+        return read_file(file)
+
+class ChannelSections(FixtureHandler):
+    def body(self):
         validate_header(self, 'Accept-Encoding', 'gzip')
         validate_argument(self, 'part', 'contentDetails')
 
         file = 'channelSections/%s.json' % self.get_argument('channelId', None)
-        self.write(read_file(file))
-        self.finish()
+        return read_file(file)
 
-class GuideCategories(ErrorHandler):
-    def get(self):
+class GuideCategories(FixtureHandler):
+    def body(self):
         validate_header(self, 'Accept-Encoding', 'gzip')
         validate_argument(self, 'part', 'snippet')
 
-        self.write(GUIDE_CATEGORIES)
-        self.finish()
+        return GUIDE_CATEGORIES
 
-class Playlists(ErrorHandler):
-    def get(self):
+class Playlists(FixtureHandler):
+    def body(self):
         validate_header(self, 'Accept-Encoding', 'gzip')
         validate_argument(self, 'part', 'snippet,contentDetails')
 
         file = 'playlists/%s.json' % self.get_argument('channelId', None)
-        self.write(read_file(file))
-        self.finish()
+        return read_file(file)
 
-class PlaylistItems(ErrorHandler):
-    def get(self):
+class PlaylistItems(FixtureHandler):
+    def body(self):
         validate_header(self, 'Accept-Encoding', 'gzip')
-        validate_argument(self, 'part', 'snippet,contentDetails')
+        validate_argument_in(self, 'part', ['snippet', 'contentDetails', 'snippet,contentDetails'])
 
         file = 'playlistItems/%s.json' % self.get_argument('playlistId', None)
-        self.write(read_file(file))
-        self.finish()
+        return read_file(file)
 
-class Search(ErrorHandler):
-    def get(self):
+class Search(FixtureHandler):
+    def body(self):
         validate_header(self, 'Accept-Encoding', 'gzip')
         validate_argument(self, 'part', 'snippet')
         validate_argument(self, 'type', 'video')
 
         q = self.get_argument('q', None)
-        channelId = self.get_argument('channelId', None)
         videoCategoryId = self.get_argument('videoCategoryId', None)
         if videoCategoryId and q:
-            self.write(read_file('search/q/%s%s.json' % ( q, videoCategoryId)))
+            return read_file('search/q/%s%s.json' % ( q, videoCategoryId))
         elif q:
-            self.write(read_file('search/q/%s.json' % q))
-        elif channelId:
-            self.write(read_file('search/channelId/%s.json' % channelId))
+            return read_file('search/q/%s.json' % q)
+        return ''
 
-        self.finish()
-
-class Videos(ErrorHandler):
-    def get(self):
+class Subscriptions(FixtureHandler):
+    def body(self):
         validate_header(self, 'Accept-Encoding', 'gzip')
         validate_argument(self, 'part', 'snippet')
+        validate_argument(self, 'mine', 'true')
 
-        videoCategoryId = self.get_argument('videoCategoryId', None)
-        if videoCategoryId:
-            self.write(read_file('videos/videoCategoryId/%s.json' % videoCategoryId))
+        return read_file('subscriptions/mine.json')
 
-        self.finish()
+class Videos(FixtureHandler):
+    def body(self):
+        validate_header(self, 'Accept-Encoding', 'gzip')
+
+        id = self.get_argument('id', None)
+        videoCategoryId = self.get_argument('videoCategoryId', None)
+        if id:
+            validate_argument_in(self, 'part', ['snippet,statistics', 'statistics'])
+            items = [json.loads(read_file('videos/id/%s.json' % v)) for v in id.split(',')]
+            return json.dumps({'kind': 'youtube#videoListResponse',
+                'pageInfo': {'totalResults': len(items), 'resultsPerPage': len(items)},
+                'items': items})
+        elif videoCategoryId:
+            validate_argument(self, 'part', 'snippet')
+            return read_file('videos/videoCategoryId/%s.json' % videoCategoryId)
+        return ''
 
 def validate_argument(self, name, expected):
     actual = self.get_argument(name, '')
     if actual != expected:
         raise Exception("Argument '%s' == '%s' != '%s'" % (name, actual, expected))
 
+def validate_argument_in(self, name, allowed):
+    actual = self.get_argument(name, '')
+    if actual not in allowed:
+        raise Exception("Argument '%s' == '%s' not in %s" % (name, actual, allowed))
+
 def validate_header(self, name, expected):
     actual = self.request.headers.get(name, '')
     if actual != expected:
@@ -136,6 +328,7 @@ def new_app():
         (r"/youtube/v3/playlists", Playlists),
         (r"/youtube/v3/playlistItems", PlaylistItems),
         (r"/youtube/v3/search", Search),
+        (r"/youtube/v3/subscriptions", Subscriptions),
     (r"/youtube/v3/videos", Videos),
     ], gzip=True)
     sockets = tornado.netutil.bind_sockets(0, '127.0.0.1')
@@ -147,6 +340,20 @@ def new_app():
 
     return application
 
+def load_faults(argv):
+    # --faults='{json}' or --faults=@path/to/file.json
+    config = os.environ.get('FAKE_YOUTUBE_FAULTS')
+    for arg in argv:
+        if arg.startswith('--faults='):
+            config = arg[len('--faults='):]
+    if not config:
+        return Faults({})
+    if config.startswith('@'):
+        with open(config[1:], 'r') as fp:
+            config = fp.read()
+    return Faults(json.loads(config))
+
 if __name__ == "__main__":
+    FAULTS = load_faults(sys.argv[1:])
     application = new_app()
     tornado.ioloop.IOLoop.instance().start()
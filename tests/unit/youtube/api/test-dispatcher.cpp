@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <youtube/api/dispatcher.h>
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace youtube::api;
+using namespace std;
+
+namespace {
+
+class TestDispatcher: public testing::Test {
+protected:
+    TestDispatcher() :
+            dispatcher_(8, Dispatcher::Limits { { 8, 6, 6, 2 } }) {
+    }
+
+    /*
+     * Submits a job that notes its name once started, and returns its
+     * ticket
+     */
+    Dispatcher::Ticket submit(Priority priority, const string &name,
+            const void *owner = nullptr) {
+        Dispatcher::Ticket ticket = dispatcher_.next_ticket();
+        dispatcher_.submit(ticket, owner ? owner : this, priority,
+                [this, name]() {
+                    started_.emplace_back(name);
+                });
+        return ticket;
+    }
+
+    unsigned int active() {
+        unsigned int total = 0;
+        for (Priority priority : { Priority::interactive,
+                Priority::surfacing, Priority::search, Priority::background }) {
+            total += dispatcher_.active(priority);
+        }
+        return total;
+    }
+
+    Dispatcher dispatcher_;
+
+    vector<string> started_;
+};
+
+TEST_F(TestDispatcher, starts_jobs_while_there_is_room) {
+    submit(Priority::surfacing, "a");
+    submit(Priority::search, "b");
+
+    EXPECT_EQ((vector<string> { "a", "b" }), started_);
+    EXPECT_EQ(1u, dispatcher_.active(Priority::surfacing));
+    EXPECT_EQ(1u, dispatcher_.active(Priority::search));
+}
+
+TEST_F(TestDispatcher, honours_the_class_limits) {
+    for (int i = 0; i < 4; ++i) {
+        submit(Priority::background, "background");
+    }
+    EXPECT_EQ(2u, dispatcher_.active(Priority::background));
+    EXPECT_EQ(2u, dispatcher_.queued(Priority::background));
+
+    for (int i = 0; i < 8; ++i) {
+        submit(Priority::surfacing, "surfacing");
+    }
+    EXPECT_EQ(6u, dispatcher_.active(Priority::surfacing));
+    EXPECT_EQ(2u, dispatcher_.queued(Priority::surfacing));
+}
+
+TEST_F(TestDispatcher, honours_the_overall_limit) {
+    for (int i = 0; i < 6; ++i) {
+        submit(Priority::search, "search");
+    }
+    for (int i = 0; i < 6; ++i) {
+        submit(Priority::surfacing, "surfacing");
+    }
+
+    // Below their class limits, but out of slots
+    EXPECT_EQ(8u, active());
+    EXPECT_EQ(6u, dispatcher_.active(Priority::search));
+    EXPECT_EQ(2u, dispatcher_.active(Priority::surfacing));
+    EXPECT_EQ(4u, dispatcher_.queued(Priority::surfacing));
+
+    submit(Priority::interactive, "interactive");
+    EXPECT_EQ(8u, active());
+    EXPECT_EQ(1u, dispatcher_.queued(Priority::interactive));
+}
+
+TEST_F(TestDispatcher, interactive_work_overtakes_queued_background_work) {
+    vector<Dispatcher::Ticket> tickets;
+    for (int i = 0; i < 6; ++i) {
+        tickets.emplace_back(submit(Priority::search, "search"));
+    }
+    for (int i = 0; i < 2; ++i) {
+        submit(Priority::surfacing, "busy");
+    }
+    submit(Priority::background, "background");
+    submit(Priority::surfacing, "surfacing");
+    submit(Priority::interactive, "interactive");
+    started_.clear();
+
+    dispatcher_.done(tickets[0]);
+    dispatcher_.done(tickets[1]);
+    dispatcher_.done(tickets[2]);
+
+    EXPECT_EQ((vector<string> { "interactive", "surfacing", "background" }),
+            started_);
+}
+
+TEST_F(TestDispatcher, done_ignores_unknown_tickets) {
+    Dispatcher::Ticket ticket = submit(Priority::search, "search");
+
+    dispatcher_.done(ticket);
+    dispatcher_.done(ticket);
+    dispatcher_.done(ticket + 100);
+    EXPECT_EQ(0u, active());
+}
+
+TEST_F(TestDispatcher, cancel_drops_queued_jobs) {
+    for (int i = 0; i < 2; ++i) {
+        submit(Priority::background, "background");
+    }
+    Dispatcher::Ticket queued = submit(Priority::background, "queued");
+
+    dispatcher_.cancel(queued);
+    EXPECT_EQ(0u, dispatcher_.queued(Priority::background));
+    EXPECT_EQ(2u, dispatcher_.active(Priority::background));
+}
+
+TEST_F(TestDispatcher, cancel_releases_the_slot) {
+    Dispatcher::Ticket first = submit(Priority::background, "first");
+    submit(Priority::background, "second");
+    submit(Priority::background, "third");
+    started_.clear();
+
+    dispatcher_.cancel(first);
+    EXPECT_EQ((vector<string> { "third" }), started_);
+    EXPECT_EQ(2u, dispatcher_.active(Priority::background));
+
+    // It will not be released twice
+    dispatcher_.done(first);
+    EXPECT_EQ(2u, dispatcher_.active(Priority::background));
+}
+
+TEST_F(TestDispatcher, abandon_releases_the_owners_slots) {
+    int mine = 0, theirs = 0;
+    for (int i = 0; i < 6; ++i) {
+        submit(Priority::search, "mine", &mine);
+    }
+    for (int i = 0; i < 4; ++i) {
+        submit(Priority::search, "theirs", &theirs);
+    }
+    submit(Priority::search, "mine queued", &mine);
+    EXPECT_EQ(6u, dispatcher_.active(Priority::search));
+    started_.clear();
+
+    dispatcher_.abandon(&mine);
+
+    // The queued job was dropped, and the other owner's took the slots
+    EXPECT_EQ((vector<string> { "theirs", "theirs", "theirs", "theirs" }),
+            started_);
+    EXPECT_EQ(4u, dispatcher_.active(Priority::search));
+    EXPECT_EQ(0u, dispatcher_.queued(Priority::search));
+}
+
+} // namespace
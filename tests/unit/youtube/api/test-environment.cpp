@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <youtube/api/environment.h>
+
+#include <gtest/gtest.h>
+#include <cstdlib>
+
+using namespace youtube::api;
+using namespace std;
+
+namespace {
+
+static const char *NAME = "YOUTUBE_SCOPE_TEST_SETTING";
+
+class TestEnvironment: public testing::Test {
+protected:
+    void TearDown() override {
+        unsetenv(NAME);
+    }
+};
+
+TEST_F(TestEnvironment, unset_gives_the_fallback) {
+    unsetenv(NAME);
+    EXPECT_EQ(2.5, env_number(NAME, 2.5));
+    EXPECT_EQ(32ul, env_whole(NAME, 32));
+}
+
+TEST_F(TestEnvironment, reads_numbers) {
+    setenv(NAME, "0.5", true);
+    EXPECT_EQ(0.5, env_number(NAME, 2.5));
+
+    setenv(NAME, "0", true);
+    EXPECT_EQ(0ul, env_whole(NAME, 32));
+    setenv(NAME, "1000", true);
+    EXPECT_EQ(1000ul, env_whole(NAME, 32));
+}
+
+TEST_F(TestEnvironment, ignores_bad_values) {
+    for (const char *value : { "", "lots", "12abc", "-3", "1e400", "nan" }) {
+        setenv(NAME, value, true);
+        EXPECT_EQ(2.5, env_number(NAME, 2.5)) << value;
+        EXPECT_EQ(32ul, env_whole(NAME, 32)) << value;
+    }
+
+    setenv(NAME, "0", true);
+    EXPECT_EQ(2.5, env_number(NAME, 2.5));
+    setenv(NAME, "1.5", true);
+    EXPECT_EQ(32ul, env_whole(NAME, 32));
+}
+
+} // namespace
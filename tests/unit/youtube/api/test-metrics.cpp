@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <youtube/api/metrics.h>
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <sstream>
+#include <string>
+
+using namespace youtube::api;
+using namespace std;
+
+namespace {
+
+typedef chrono::microseconds Micros;
+
+TEST(TestHistogram, empty) {
+    Histogram histogram;
+    EXPECT_EQ(0ul, histogram.count());
+    EXPECT_EQ(Histogram::Clock::duration::zero(), histogram.mean());
+    EXPECT_EQ(Histogram::Clock::duration::zero(), histogram.max());
+    EXPECT_EQ(Histogram::Clock::duration::zero(), histogram.percentile(0.5));
+}
+
+TEST(TestHistogram, small_values_are_exact) {
+    Histogram histogram;
+    for (int i = 0; i < 10; ++i) {
+        histogram.record(Micros(i));
+    }
+    EXPECT_EQ(10ul, histogram.count());
+    EXPECT_EQ(Micros(4), histogram.mean());
+    EXPECT_EQ(Micros(9), histogram.max());
+    EXPECT_EQ(Micros(4), histogram.percentile(0.5));
+    EXPECT_EQ(Micros(9), histogram.percentile(1.0));
+}
+
+TEST(TestHistogram, percentiles_are_within_the_bucket_width) {
+    Histogram histogram;
+    for (int i = 1; i <= 1000; ++i) {
+        histogram.record(chrono::milliseconds(i));
+    }
+    EXPECT_EQ(1000ul, histogram.count());
+    EXPECT_EQ(Micros(500500), histogram.mean());
+    EXPECT_EQ(chrono::milliseconds(1000), histogram.max());
+
+    for (double fraction : { 0.5, 0.9, 0.99 }) {
+        double expected = fraction * 1000000;
+        double actual = chrono::duration_cast<Micros>(
+                histogram.percentile(fraction)).count();
+        EXPECT_LE(actual, expected) << fraction;
+        EXPECT_GE(actual, expected * 0.93) << fraction;
+    }
+}
+
+TEST(TestMetrics, adds_up_each_endpoint) {
+    Metrics metrics;
+    metrics.sent("search", 100);
+    metrics.sent("search", 50);
+    metrics.received("search", 2000);
+    metrics.decoded("search", 8000);
+    metrics.failed("search");
+    metrics.cache_hit("search");
+    metrics.cache_hit("search");
+
+    metrics.sent("videos/rate", 10);
+
+    Metrics::Snapshot snapshot = metrics.snapshot();
+    ASSERT_EQ(2u, snapshot.size());
+
+    const Metrics::Endpoint &search = snapshot["search"];
+    EXPECT_EQ(2ul, search.requests);
+    EXPECT_EQ(1ul, search.errors);
+    EXPECT_EQ(2ul, search.cache_hits);
+    EXPECT_EQ(150ull, search.bytes_out);
+    EXPECT_EQ(2000ull, search.bytes_in);
+    EXPECT_EQ(8000ull, search.bytes_decoded);
+
+    const Metrics::Endpoint &rate = snapshot["videos/rate"];
+    EXPECT_EQ(1ul, rate.requests);
+    EXPECT_EQ(0ul, rate.errors);
+    EXPECT_EQ(10ull, rate.bytes_out);
+}
+
+TEST(TestMetrics, records_latency_by_phase) {
+    Metrics metrics;
+    metrics.record("channels", Metrics::Phase::queue, chrono::milliseconds(1));
+    metrics.record("channels", Metrics::Phase::transfer,
+            chrono::milliseconds(30));
+    metrics.record("channels", Metrics::Phase::transfer,
+            chrono::milliseconds(50));
+
+    Metrics::Endpoint channels = metrics.snapshot()["channels"];
+    const auto &queue =
+            channels.latency[static_cast<size_t>(Metrics::Phase::queue)];
+    const auto &transfer =
+            channels.latency[static_cast<size_t>(Metrics::Phase::transfer)];
+    const auto &parse =
+            channels.latency[static_cast<size_t>(Metrics::Phase::parse)];
+
+    EXPECT_EQ(1ul, queue.count());
+    EXPECT_EQ(2ul, transfer.count());
+    EXPECT_EQ(0ul, parse.count());
+    EXPECT_EQ(chrono::milliseconds(40), transfer.mean());
+    EXPECT_EQ(chrono::milliseconds(50), transfer.max());
+
+    // Timings alone are not requests
+    EXPECT_EQ(0ul, channels.requests);
+}
+
+TEST(TestMetrics, snapshot_is_a_copy) {
+    Metrics metrics;
+    metrics.sent("search", 1);
+    Metrics::Snapshot snapshot = metrics.snapshot();
+    metrics.sent("search", 1);
+
+    EXPECT_EQ(1ul, snapshot["search"].requests);
+    EXPECT_EQ(2ul, metrics.snapshot()["search"].requests);
+}
+
+TEST(TestMetrics, dumps_only_recorded_phases) {
+    Metrics metrics;
+    metrics.sent("search", 100);
+    metrics.record("search", Metrics::Phase::parse, chrono::milliseconds(2));
+
+    ostringstream out;
+    metrics.dump(out);
+    string dump = out.str();
+
+    EXPECT_NE(string::npos, dump.find("search: requests=1 errors=0"));
+    EXPECT_NE(string::npos, dump.find("  parse: count=1"));
+    EXPECT_EQ(string::npos, dump.find("transfer"));
+    EXPECT_EQ(string::npos, dump.find("queue"));
+}
+
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <youtube/api/quota.h>
+
+#include <gtest/gtest.h>
+
+using namespace youtube::api;
+using namespace std;
+
+namespace {
+
+TEST(Quota, spends_the_bucket_before_delaying) {
+    Quota quota(1000, 3.0, 1.0);
+    chrono::milliseconds delay;
+
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(quota.reserve("videos", false, delay));
+        EXPECT_EQ(chrono::milliseconds::zero(), delay);
+    }
+
+    // Each further request waits out one more unit of debt
+    ASSERT_TRUE(quota.reserve("videos", false, delay));
+    EXPECT_NEAR(1000, delay.count(), 50);
+    ASSERT_TRUE(quota.reserve("videos", false, delay));
+    EXPECT_NEAR(2000, delay.count(), 50);
+}
+
+TEST(Quota, refuses_long_delays) {
+    Quota quota(1000, 10.0, 10.0);
+    chrono::milliseconds delay;
+
+    // A search costs 100 units, 9s of refill
+    EXPECT_FALSE(quota.reserve("search", false, delay));
+    EXPECT_EQ(1000u, quota.remaining());
+}
+
+TEST(Quota, refuses_past_the_budget) {
+    Quota quota(100, 1000.0, 10.0);
+    chrono::milliseconds delay;
+
+    ASSERT_TRUE(quota.reserve("search", false, delay));
+    EXPECT_FALSE(quota.reserve("videos", false, delay));
+    EXPECT_EQ(0u, quota.remaining());
+}
+
+} // namespace
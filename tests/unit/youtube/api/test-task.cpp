@@ -0,0 +1,203 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <youtube/api/task.h>
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace youtube::api;
+using namespace std;
+
+namespace {
+
+TEST(Task, then_passes_on_a_value) {
+    Task<int> task;
+    auto next = task.then([](int value) {
+        return to_string(value * 2);
+    });
+    EXPECT_EQ(future_status::timeout, next.wait_for(chrono::milliseconds(0)));
+
+    task.set_value(21);
+    EXPECT_EQ("42", next.get());
+}
+
+TEST(Task, then_runs_straight_away_once_settled) {
+    auto next = Task<int>::ready(1).then([](int value) {
+        return value + 1;
+    });
+    EXPECT_EQ(future_status::ready, next.wait_for(chrono::milliseconds(0)));
+    EXPECT_EQ(2, next.get());
+}
+
+TEST(Task, then_waits_for_a_returned_task) {
+    Task<int> task;
+    Task<string> inner;
+    auto next = task.then([inner](int) {
+        return inner;
+    });
+
+    task.set_value(1);
+    EXPECT_EQ(future_status::timeout, next.wait_for(chrono::milliseconds(0)));
+
+    inner.set_value("done");
+    EXPECT_EQ("done", next.get());
+}
+
+TEST(Task, errors_skip_continuations) {
+    Task<int> task;
+    bool called = false;
+    auto next = task.then([&called](int value) {
+        called = true;
+        return value;
+    }).then([&called](int value) {
+        called = true;
+        return value;
+    });
+
+    task.set_exception(make_exception_ptr(runtime_error("broken")));
+    EXPECT_THROW(next.get(), runtime_error);
+    EXPECT_FALSE(called);
+}
+
+TEST(Task, a_throwing_continuation_fails_the_next_task) {
+    auto next = Task<int>::ready(1).then([](int) -> int {
+        throw logic_error("bad");
+    });
+    EXPECT_THROW(next.get(), logic_error);
+}
+
+TEST(Task, inner_task_errors_are_passed_on) {
+    Task<int> inner;
+    auto next = Task<int>::ready(1).then([inner](int) {
+        return inner;
+    });
+
+    inner.set_exception(make_exception_ptr(runtime_error("inner")));
+    EXPECT_THROW(next.get(), runtime_error);
+}
+
+TEST(Task, finally_runs_on_failure) {
+    Task<int> task;
+    bool called = false;
+    task.finally([&called]() {
+        called = true;
+    });
+
+    task.set_exception(make_exception_ptr(runtime_error("broken")));
+    EXPECT_TRUE(called);
+}
+
+TEST(Task, cancel_fails_with_cancelled) {
+    Task<int> task;
+    int cancellers = 0;
+    task.on_cancel([&cancellers]() {
+        ++cancellers;
+    });
+
+    task.cancel();
+    task.cancel();
+    EXPECT_THROW(task.get(), Cancelled);
+    EXPECT_EQ(1, cancellers);
+}
+
+TEST(Task, cancelling_a_continuation_reaches_upstream) {
+    Task<int> task;
+    bool cancelled = false;
+    task.on_cancel([&cancelled]() {
+        cancelled = true;
+    });
+
+    auto next = task.then([](int value) {
+        return value;
+    });
+    next.cancel();
+
+    EXPECT_TRUE(cancelled);
+    EXPECT_THROW(task.get(), Cancelled);
+    EXPECT_THROW(next.get(), Cancelled);
+}
+
+TEST(Task, cancelling_a_continuation_reaches_the_inner_task) {
+    Task<int> inner;
+    bool cancelled = false;
+    inner.on_cancel([&cancelled]() {
+        cancelled = true;
+    });
+
+    auto next = Task<int>::ready(1).then([inner](int) {
+        return inner;
+    });
+    next.cancel();
+
+    EXPECT_TRUE(cancelled);
+    EXPECT_THROW(inner.get(), Cancelled);
+    EXPECT_THROW(next.get(), Cancelled);
+}
+
+TEST(Task, settled_tasks_ignore_cancel) {
+    bool cancelled = false;
+    auto task = Task<int>::ready(1);
+    task.on_cancel([&cancelled]() {
+        cancelled = true;
+    });
+
+    task.cancel();
+    EXPECT_FALSE(cancelled);
+    EXPECT_EQ(1, task.get());
+}
+
+TEST(Task, first_settle_wins) {
+    Task<int> task;
+    task.set_value(1);
+    task.set_value(2);
+    task.set_exception(make_exception_ptr(runtime_error("late")));
+    EXPECT_EQ(1, task.get());
+}
+
+TEST(Task, racing_settles_call_back_once) {
+    for (int round = 0; round < 100; ++round) {
+        Task<int> task;
+        atomic<int> callbacks(0);
+        task.finally([&callbacks]() {
+            ++callbacks;
+        });
+
+        // A response and a cancellation arriving together
+        vector<thread> threads;
+        for (int i = 0; i < 4; ++i) {
+            threads.emplace_back([task, i]() {
+                if (i % 2) {
+                    task.cancel();
+                } else {
+                    task.set_value(i);
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+
+        EXPECT_EQ(1, callbacks);
+        EXPECT_EQ(future_status::ready, task.wait_for(chrono::seconds(0)));
+    }
+}
+
+} // namespace
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <youtube/api/timer.h>
+
+#include <gtest/gtest.h>
+
+#include <future>
+#include <vector>
+
+using namespace youtube::api;
+using namespace std;
+
+namespace {
+
+TEST(Timer, runs_jobs_in_due_order) {
+    Timer timer;
+    mutex order_mutex;
+    vector<int> order;
+    promise<void> finished;
+
+    timer.schedule(chrono::milliseconds(60), [&]() {
+        lock_guard<mutex> lock(order_mutex);
+        order.emplace_back(2);
+        finished.set_value();
+    });
+    timer.schedule(chrono::milliseconds(20), [&]() {
+        lock_guard<mutex> lock(order_mutex);
+        order.emplace_back(1);
+    });
+
+    auto scheduled = Timer::Clock::now();
+    ASSERT_EQ(future_status::ready,
+            finished.get_future().wait_for(chrono::seconds(5)));
+    EXPECT_GE(Timer::Clock::now() - scheduled, chrono::milliseconds(60));
+
+    lock_guard<mutex> lock(order_mutex);
+    EXPECT_EQ(vector<int>({ 1, 2 }), order);
+}
+
+TEST(Timer, drops_jobs_not_yet_due) {
+    bool ran = false;
+    {
+        Timer timer;
+        timer.schedule(chrono::hours(1), [&ran]() {
+            ran = true;
+        });
+        EXPECT_EQ(1u, timer.pending());
+    }
+    EXPECT_FALSE(ran);
+}
+
+} // namespace
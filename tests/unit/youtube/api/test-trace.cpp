@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <youtube/api/trace.h>
+
+#include <gtest/gtest.h>
+#include <json/json.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <unistd.h>
+#include <vector>
+
+using namespace youtube::api;
+using namespace std;
+
+namespace json = Json;
+
+namespace {
+
+/*
+ * The process-wide tracer is set up once from the environment, so the
+ * tests make their own
+ */
+class TestTracer: public Tracer {
+public:
+    TestTracer(const string &path) :
+            Tracer(path) {
+    }
+};
+
+class TestTrace: public testing::Test {
+protected:
+    void SetUp() override {
+        char path[] = "/tmp/test-trace-XXXXXX";
+        int fd = mkstemp(path);
+        ASSERT_NE(-1, fd);
+        close(fd);
+        path_ = path;
+    }
+
+    void TearDown() override {
+        remove(path_.c_str());
+    }
+
+    json::Value read() {
+        ifstream in(path_);
+        json::Value root;
+        json::Reader reader;
+        EXPECT_TRUE(reader.parse(in, root))
+                << reader.getFormattedErrorMessages();
+        return root;
+    }
+
+    string path_;
+};
+
+TEST_F(TestTrace, disabled_without_a_path) {
+    TestTracer tracer("");
+    EXPECT_FALSE(tracer.enabled());
+
+    auto now = Tracer::Clock::now();
+    tracer.complete("query", "scope", now, now);
+    tracer.flush();
+}
+
+TEST_F(TestTrace, writes_chrome_trace_events) {
+    {
+        TestTracer tracer(path_);
+        ASSERT_TRUE(tracer.enabled());
+
+        auto start = Tracer::Clock::now();
+        auto end = start + chrono::milliseconds(3);
+        tracer.complete("preview-playable", "scope", start, end);
+        tracer.async("search", "http", 1, start, end);
+        tracer.async("videos", "http", 2, start + chrono::milliseconds(1),
+                end + chrono::milliseconds(1));
+
+        // Requests finish on other threads
+        vector<thread> threads;
+        for (unsigned long id = 3; id < 7; ++id) {
+            threads.emplace_back([&tracer, id, start]() {
+                tracer.async("channels", "http", id, start,
+                        Tracer::Clock::now());
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+    }
+
+    // Written out when the tracer goes away
+    json::Value root = read();
+    ASSERT_TRUE(root.isObject());
+    EXPECT_EQ("ms", root["displayTimeUnit"].asString());
+
+    const json::Value &events = root["traceEvents"];
+    ASSERT_TRUE(events.isArray());
+    ASSERT_EQ(13u, events.size());
+
+    typedef tuple<string, string, json::UInt64> Key;
+    map<Key, json::Int64> begun;
+    unsigned int complete = 0, ended = 0;
+
+    for (const json::Value &event : events) {
+        ASSERT_TRUE(event["name"].isString());
+        ASSERT_TRUE(event["cat"].isString());
+        ASSERT_TRUE(event["ts"].isIntegral());
+        EXPECT_EQ(getpid(), event["pid"].asInt());
+        EXPECT_TRUE(event["tid"].isIntegral());
+
+        string phase = event["ph"].asString();
+        if (phase == "X") {
+            ++complete;
+            EXPECT_EQ("preview-playable", event["name"].asString());
+            EXPECT_EQ(3000, event["dur"].asInt64());
+            continue;
+        }
+
+        Key key(event["name"].asString(), event["cat"].asString(),
+                event["id"].asUInt64());
+        if (phase == "b") {
+            EXPECT_EQ(0u, begun.count(key));
+            begun[key] = event["ts"].asInt64();
+        } else {
+            ASSERT_EQ("e", phase);
+            // Every end follows the begin of the same name, category and id
+            ASSERT_EQ(1u, begun.count(key));
+            EXPECT_GE(event["ts"].asInt64(), begun[key]);
+            begun.erase(key);
+            ++ended;
+        }
+    }
+
+    EXPECT_EQ(1u, complete);
+    EXPECT_EQ(6u, ended);
+    EXPECT_TRUE(begun.empty());
+}
+
+TEST_F(TestTrace, flush_rewrites_the_file) {
+    TestTracer tracer(path_);
+    auto now = Tracer::Clock::now();
+
+    tracer.complete("first", "scope", now, now);
+    tracer.flush();
+    EXPECT_EQ(1u, read()["traceEvents"].size());
+
+    tracer.complete("second", "scope", now, now);
+    tracer.flush();
+    json::Value events = read()["traceEvents"];
+    ASSERT_EQ(2u, events.size());
+    EXPECT_EQ("first", events[0]["name"].asString());
+    EXPECT_EQ("second", events[1]["name"].asString());
+}
+
+}
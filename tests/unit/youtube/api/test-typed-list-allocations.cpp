@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <allocation-counter.h>
+
+#include <youtube/api/channel.h>
+#include <youtube/api/playlist.h>
+#include <youtube/api/playlist-item.h>
+#include <youtube/api/typed-list.h>
+#include <youtube/api/video.h>
+
+#include <gtest/gtest.h>
+#include <json/json.h>
+#include <fstream>
+#include <string>
+
+using namespace std;
+using namespace youtube;
+using namespace youtube::api;
+
+namespace {
+
+Json::Value load(const string &path) {
+    ifstream in(string(FAKE_YOUTUBE_FIXTURES) + "/" + path);
+    Json::Reader reader;
+    Json::Value root;
+    EXPECT_TRUE(reader.parse(in, root)) << path;
+    return root;
+}
+
+/*
+ * Heap allocations per item when building the models from a parsed
+ * response. The bounds are the counts at the time of writing plus some
+ * headroom, and should come down as parsing gets cheaper.
+ */
+template<typename T>
+double allocations_per_item(const string &kind, const string &path) {
+    Json::Value root = load(path);
+
+    CountAllocations counter;
+    auto items = get_typed_list<T>(kind, root);
+    EXPECT_FALSE(items.empty());
+    return double(counter.count()) / items.size();
+}
+
+TEST(TypedListAllocations, video) {
+    EXPECT_LE(allocations_per_item<Video>("youtube#video",
+            "videos/videoCategoryId/10.json"), 180);
+}
+
+TEST(TypedListAllocations, channel) {
+    EXPECT_LE(allocations_per_item<Channel>("youtube#channel",
+            "channels/GCTXVzaWM.json"), 120);
+}
+
+TEST(TypedListAllocations, playlist) {
+    EXPECT_LE(allocations_per_item<Playlist>("youtube#playlist",
+            "playlists/UC20vb-R_px4CguHzzBPhoyQ.json"), 180);
+}
+
+TEST(TypedListAllocations, playlist_item) {
+    EXPECT_LE(allocations_per_item<PlaylistItem>("youtube#playlistItem",
+            "playlistItems/PLEE58C6029A8A6ADE.json"), 190);
+}
+
+} // namespace
@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <youtube/api/uploads-cache.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+using namespace youtube::api;
+using namespace std;
+
+namespace {
+
+class TestUploadsCache: public testing::Test {
+protected:
+    void SetUp() override {
+        char dir[] = "/tmp/uploads-cache-XXXXXX";
+        ASSERT_NE(nullptr, mkdtemp(dir));
+        path_ = string(dir) + "/uploads.json";
+    }
+
+    void TearDown() override {
+        remove(path_.c_str());
+        remove(path_.substr(0, path_.rfind('/')).c_str());
+    }
+
+    string path_;
+};
+
+TEST_F(TestUploadsCache, survives_a_restart) {
+    {
+        UploadsCache cache;
+        cache.persist(path_);
+        cache.put("UC1", "UU1");
+        cache.put("UC2", "UU2");
+        cache.save();
+    }
+
+    UploadsCache cache;
+    cache.persist(path_);
+    string uploads;
+    EXPECT_EQ(2u, cache.size());
+    ASSERT_TRUE(cache.get("UC2", uploads));
+    EXPECT_EQ("UU2", uploads);
+}
+
+TEST_F(TestUploadsCache, only_writes_when_changed) {
+    UploadsCache cache;
+    cache.persist(path_);
+    cache.save();
+    EXPECT_FALSE(ifstream(path_).good());
+
+    cache.put("UC1", "UU1");
+    cache.save();
+    EXPECT_TRUE(ifstream(path_).good());
+}
+
+TEST_F(TestUploadsCache, ignores_a_corrupt_file) {
+    ofstream(path_) << "{ not json";
+
+    UploadsCache cache;
+    cache.persist(path_);
+    EXPECT_EQ(0u, cache.size());
+
+    cache.put("UC1", "UU1");
+    cache.save();
+
+    UploadsCache reloaded;
+    reloaded.persist(path_);
+    EXPECT_EQ(1u, reloaded.size());
+}
+
+TEST_F(TestUploadsCache, evicts_the_least_recently_used) {
+    UploadsCache cache(2);
+    cache.put("UC1", "UU1");
+    cache.put("UC2", "UU2");
+    string uploads;
+    ASSERT_TRUE(cache.get("UC1", uploads));
+
+    cache.put("UC3", "UU3");
+    EXPECT_EQ(2u, cache.size());
+    EXPECT_TRUE(cache.get("UC1", uploads));
+    EXPECT_FALSE(cache.get("UC2", uploads));
+    EXPECT_TRUE(cache.get("UC3", uploads));
+}
+
+TEST_F(TestUploadsCache, loads_no_more_than_fit) {
+    {
+        UploadsCache cache;
+        cache.persist(path_);
+        cache.put("UC1", "UU1");
+        cache.put("UC2", "UU2");
+        cache.put("UC3", "UU3");
+        cache.save();
+    }
+
+    // The most recently used are kept, behind what this run learned
+    UploadsCache cache(3);
+    cache.put("UC4", "UU4");
+    cache.persist(path_);
+    string uploads;
+    EXPECT_EQ(3u, cache.size());
+    EXPECT_TRUE(cache.get("UC4", uploads));
+    EXPECT_TRUE(cache.get("UC3", uploads));
+    EXPECT_TRUE(cache.get("UC2", uploads));
+    EXPECT_FALSE(cache.get("UC1", uploads));
+}
+
+} // namespace
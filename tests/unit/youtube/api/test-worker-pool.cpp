@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <youtube/api/worker-pool.h>
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <vector>
+
+using namespace youtube::api;
+using namespace std;
+
+namespace {
+
+/*
+ * Holds the pool's only thread until released
+ */
+class Blocker {
+public:
+    Blocker(WorkerPool &pool) :
+            release_(make_shared<promise<void>>()) {
+        auto started = make_shared<promise<void>>();
+        auto release = release_->get_future().share();
+        pool.post([started, release]() {
+            started->set_value();
+            release.wait();
+        });
+        started->get_future().wait();
+    }
+
+    void release() {
+        release_->set_value();
+    }
+
+protected:
+    shared_ptr<promise<void>> release_;
+};
+
+TEST(TestWorkerPool, runs_jobs_in_order) {
+    WorkerPool pool(1);
+    vector<int> ran;
+    promise<void> done;
+
+    for (int i = 0; i < 5; ++i) {
+        pool.post([&ran, i]() {
+            ran.emplace_back(i);
+        });
+    }
+    pool.post([&done]() {
+        done.set_value();
+    });
+
+    ASSERT_EQ(future_status::ready,
+            done.get_future().wait_for(chrono::seconds(5)));
+    EXPECT_EQ((vector<int> { 0, 1, 2, 3, 4 }), ran);
+}
+
+TEST(TestWorkerPool, counts_queued_and_completed_jobs) {
+    WorkerPool pool(1);
+    Blocker blocker(pool);
+
+    for (int i = 0; i < 3; ++i) {
+        pool.post([]() {
+        });
+    }
+    EXPECT_EQ(3u, pool.queued());
+
+    WorkerPool::Stats stats = pool.stats();
+    EXPECT_EQ(3u, stats.queued);
+    EXPECT_EQ(3u, stats.peak_queued);
+    EXPECT_EQ(0ul, stats.completed);
+
+    this_thread::sleep_for(chrono::milliseconds(20));
+    blocker.release();
+
+    promise<void> done;
+    pool.post([&done]() {
+        done.set_value();
+    });
+    ASSERT_EQ(future_status::ready,
+            done.get_future().wait_for(chrono::seconds(5)));
+
+    // The last job's own bookkeeping happens just after it settles
+    for (int i = 0; i < 100 && pool.stats().completed < 5; ++i) {
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    stats = pool.stats();
+    EXPECT_EQ(0u, stats.queued);
+    EXPECT_EQ(3u, stats.peak_queued);
+    EXPECT_EQ(5ul, stats.completed);
+
+    // Three jobs sat behind the blocker, which itself ran that long
+    EXPECT_GE(stats.waiting, chrono::milliseconds(60));
+    EXPECT_GE(stats.running, chrono::milliseconds(20));
+}
+
+TEST(TestWorkerPool, finishes_queued_jobs_when_destroyed) {
+    atomic<int> ran(0);
+    {
+        WorkerPool pool(1);
+        Blocker blocker(pool);
+        for (int i = 0; i < 4; ++i) {
+            pool.post([&ran]() {
+                ++ran;
+            });
+        }
+        blocker.release();
+    }
+    EXPECT_EQ(4, ran);
+}
+
+TEST(TestWorkerPool, has_at_least_one_thread) {
+    WorkerPool pool(0);
+    EXPECT_EQ(1u, pool.size());
+
+    promise<void> done;
+    pool.post([&done]() {
+        done.set_value();
+    });
+    EXPECT_EQ(future_status::ready,
+            done.get_future().wait_for(chrono::seconds(5)));
+}
+
+}
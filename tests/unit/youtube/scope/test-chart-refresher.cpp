@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <youtube/scope/chart-refresher.h>
+
+#include <core/posix/exec.h>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+
+using namespace std;
+using namespace youtube::api;
+using namespace youtube::scope;
+
+namespace posix = core::posix;
+
+namespace {
+
+class TestChartRefresher: public testing::Test {
+protected:
+    TestChartRefresher() :
+            cache_(chrono::seconds(900)), refresher_(cache_,
+                    make_shared<Client>(nullptr), chrono::seconds(120)) {
+    }
+
+    ChartCache cache_;
+
+    ChartRefresher refresher_;
+};
+
+TEST_F(TestChartRefresher, unrequested_charts_are_not_refreshed) {
+    EXPECT_EQ(ChartRefresher::Clock::duration::zero(),
+            refresher_.interval("US", ""));
+}
+
+TEST_F(TestChartRefresher, rare_charts_refresh_slowly) {
+    refresher_.requested("US", "");
+
+    EXPECT_EQ(chrono::seconds(600), refresher_.interval("US", ""));
+}
+
+TEST_F(TestChartRefresher, popular_charts_refresh_quickly) {
+    for (int i = 0; i < 10; ++i) {
+        refresher_.requested("US", ChartCache::MUSIC_CATEGORY_ID);
+    }
+
+    EXPECT_EQ(chrono::seconds(120),
+            refresher_.interval("US", ChartCache::MUSIC_CATEGORY_ID));
+    EXPECT_EQ(ChartRefresher::Clock::duration::zero(),
+            refresher_.interval("GB", ChartCache::MUSIC_CATEGORY_ID));
+}
+
+/*
+ * A client whose chart continuations, on the parser pool, hold a
+ * reference to it until the test lets them go
+ */
+class HeldClient: public Client {
+public:
+    struct Gate {
+        atomic<bool> entering { false };
+
+        promise<void> entered;
+
+        promise<void> released;
+    };
+
+    HeldClient(const shared_ptr<Gate> &gate) :
+            Client(nullptr), gate_(gate), released_(
+                    gate->released.get_future().share()) {
+    }
+
+    Task<VideoList> chart_videos(const string &chart_name,
+            const string &region_code, const string &category_id) override {
+        weak_ptr<Client> weak_self = self;
+        shared_ptr<Gate> gate = gate_;
+        shared_future<void> released = released_;
+        return Client::chart_videos(chart_name, region_code, category_id).then(
+                [weak_self, gate, released](const VideoList &videos) {
+                    shared_ptr<Client> self = weak_self.lock();
+                    if (!gate->entering.exchange(true)) {
+                        gate->entered.set_value();
+                    }
+                    released.wait();
+                    return videos;
+                });
+    }
+
+    weak_ptr<Client> self;
+
+protected:
+    shared_ptr<Gate> gate_;
+
+    shared_future<void> released_;
+};
+
+class TestChartRefresherServer: public testing::Test {
+protected:
+    void SetUp() override {
+        fake_youtube_server_ = posix::exec(FAKE_YOUTUBE_SERVER, { }, { },
+                posix::StandardStream::stdout);
+
+        ASSERT_GT(fake_youtube_server_.pid(), 0);
+        string port;
+        fake_youtube_server_.cout() >> port;
+
+        string apiroot = "http://127.0.0.1:" + port;
+        setenv("YOUTUBE_SCOPE_APIROOT", apiroot.c_str(), true);
+        setenv("YOUTUBE_SCOPE_IGNORE_ACCOUNTS", "true", true);
+    }
+
+    static unsigned long parsed() {
+        return Client(nullptr).parse_stats().completed;
+    }
+
+    posix::ChildProcess fake_youtube_server_ = posix::ChildProcess::invalid();
+};
+
+TEST_F(TestChartRefresherServer, destroyed_during_refresh) {
+    auto gate = make_shared<HeldClient::Gate>();
+    auto client = make_shared<HeldClient>(gate);
+    client->self = client;
+
+    ChartCache cache(chrono::seconds(900));
+    unique_ptr<ChartRefresher> refresher(
+            new ChartRefresher(cache, client, chrono::seconds(120)));
+    client.reset();
+    unsigned long before = parsed();
+
+    refresher->warm("US");
+    ASSERT_EQ(future_status::ready,
+            gate->entered.get_future().wait_for(chrono::seconds(10)));
+
+    // Now the continuation holds the last reference, so the client is
+    // destroyed from inside its own parse job
+    refresher.reset();
+    gate->released.set_value();
+
+    auto deadline = chrono::steady_clock::now() + chrono::seconds(10);
+    while (parsed() == before && chrono::steady_clock::now() < deadline) {
+        this_thread::sleep_for(chrono::milliseconds(10));
+    }
+    EXPECT_LT(before, parsed());
+}
+
+} // namespace
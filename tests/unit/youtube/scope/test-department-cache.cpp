@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <youtube/scope/department-cache.h>
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <string>
+
+using namespace std;
+using namespace youtube::scope;
+
+namespace sc = unity::scopes;
+
+namespace {
+
+DepartmentCache::Tree make_tree() {
+    sc::CannedQuery query(SCOPE_NAME, "", "");
+    sc::Department::SPtr root = sc::Department::create("", query, "Best of YouTube");
+    root->add_subdepartment(sc::Department::create("guideCategory:GCTXVzaWM",
+            query, "Music"));
+    return DepartmentCache::Tree { root, "GCQmVzdCBvZiBZb3VUdWJl" };
+}
+
+TEST(DepartmentCache, stores_tree) {
+    DepartmentCache cache(chrono::seconds(60));
+    string key = DepartmentCache::key("US", "en_US", false, "");
+
+    cache.put(key, make_tree(), cache.version());
+
+    DepartmentCache::Tree tree;
+    ASSERT_TRUE(cache.get(key, tree));
+    EXPECT_EQ("GCQmVzdCBvZiBZb3VUdWJl", tree.first_category_id);
+    EXPECT_FALSE(cache.get(DepartmentCache::key("GB", "en_US", false, ""), tree));
+}
+
+TEST(DepartmentCache, subscribing_drops_trees) {
+    DepartmentCache cache(chrono::seconds(60));
+    string key = DepartmentCache::key("US", "en_US", true, "UC1");
+
+    // Built before the change, so already out of date
+    unsigned long version = cache.version();
+    cache.put(key, make_tree(), version);
+    cache.subscriptions_changed();
+    cache.put(key, make_tree(), version);
+
+    DepartmentCache::Tree tree;
+    EXPECT_FALSE(cache.get(key, tree));
+}
+
+TEST(DepartmentCache, with_subdepartment_copies_root) {
+    DepartmentCache::Tree tree = make_tree();
+    sc::CannedQuery query(SCOPE_NAME, "", "channel:UC1");
+
+    auto root = DepartmentCache::with_subdepartment(tree, query, "channel:UC1");
+
+    EXPECT_EQ(2u, root->subdepartments().size());
+    EXPECT_EQ(1u, tree.root->subdepartments().size());
+}
+
+TEST(DepartmentCache, for_query_points_at_current_query) {
+    DepartmentCache::Tree tree = make_tree();
+    sc::CannedQuery query(SCOPE_NAME, "later", "");
+
+    auto root = DepartmentCache::for_query(tree, query);
+
+    ASSERT_EQ(1u, root->subdepartments().size());
+    EXPECT_EQ("later", root->query().query_string());
+    auto music = root->subdepartments().front();
+    EXPECT_EQ("guideCategory:GCTXVzaWM", music->id());
+    EXPECT_EQ("later", music->query().query_string());
+    EXPECT_EQ("", tree.root->query().query_string());
+}
+
+TEST(DepartmentCache, for_query_without_departments) {
+    sc::CannedQuery query(SCOPE_NAME, "", "");
+    EXPECT_EQ(nullptr, DepartmentCache::for_query(DepartmentCache::Tree(), query));
+}
+
+TEST(DepartmentCache, binds_each_query_once) {
+    DepartmentCache cache(chrono::seconds(60));
+    string key = DepartmentCache::key("US", "en_US", false, "");
+    cache.put(key, make_tree(), cache.version());
+    DepartmentCache::Tree tree;
+    ASSERT_TRUE(cache.get(key, tree));
+
+    sc::CannedQuery query(SCOPE_NAME, "", "guideCategory:GCTXVzaWM");
+    auto root = cache.bind(key, tree, query);
+    EXPECT_EQ(root, cache.bind(key, tree, query));
+
+    sc::CannedQuery other(SCOPE_NAME, "", "channel:UC1");
+    auto with_channel = cache.bind(key, tree, other, "channel:UC1");
+    EXPECT_NE(root, with_channel);
+    EXPECT_EQ(2u, with_channel->subdepartments().size());
+    EXPECT_EQ(with_channel, cache.bind(key, tree, other, "channel:UC1"));
+}
+
+TEST(DepartmentCache, rebinds_a_replaced_tree) {
+    DepartmentCache cache(chrono::seconds(60));
+    string key = DepartmentCache::key("US", "en_US", false, "");
+    sc::CannedQuery query(SCOPE_NAME, "", "");
+
+    cache.put(key, make_tree(), cache.version());
+    DepartmentCache::Tree tree;
+    ASSERT_TRUE(cache.get(key, tree));
+    auto root = cache.bind(key, tree, query);
+
+    cache.put(key, make_tree(), cache.version());
+    ASSERT_TRUE(cache.get(key, tree));
+    EXPECT_NE(root, cache.bind(key, tree, query));
+}
+
+} // namespace
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <youtube/api/task.h>
+#include <youtube/scope/fan-out.h>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace youtube::api;
+using namespace youtube::scope;
+using namespace std;
+
+namespace {
+
+class TestFanOut: public testing::Test {
+protected:
+    /*
+     * Requests that only settle when cancelled, apart from the first
+     */
+    Task<int> start(int input) {
+        Task<int> task;
+        task.on_cancel([this, input]() {
+            cancelled_.emplace_back(input);
+        });
+        if (input == 0) {
+            task.set_value(input);
+        }
+        started_.emplace_back(input);
+        return task;
+    }
+
+    FanOut fan_out_ { 4, 4, 4, chrono::milliseconds(1000) };
+
+    vector<int> started_;
+
+    vector<int> cancelled_;
+};
+
+TEST_F(TestFanOut, cancels_the_window_when_a_consumer_throws) {
+    vector<int> inputs { 0, 1, 2, 3, 4, 5 };
+
+    EXPECT_THROW(fan_out_.run(inputs, [this](int input) {
+        return start(input);
+    }, [](int, int) {
+        throw Cancelled();
+    }), Cancelled);
+
+    EXPECT_EQ(vector<int>({ 0, 1, 2, 3 }), started_);
+    EXPECT_EQ(vector<int>({ 1, 2, 3 }), cancelled_);
+}
+
+TEST_F(TestFanOut, cancels_the_window_once_enough_arrived) {
+    vector<int> inputs { 0, 1, 2, 3, 4, 5 };
+    vector<int> consumed;
+
+    fan_out_.run(inputs, [this](int input) {
+        return start(input);
+    }, [&consumed](int input, int) {
+        consumed.emplace_back(input);
+    }, [&consumed](size_t) {
+        return consumed.empty();
+    });
+
+    EXPECT_EQ(vector<int>({ 0 }), consumed);
+    EXPECT_EQ(vector<int>({ 0, 1, 2, 3 }), started_);
+    EXPECT_EQ(vector<int>({ 1, 2, 3 }), cancelled_);
+}
+
+TEST_F(TestFanOut, cancelling_a_continuation_cancels_its_source) {
+    Task<int> source;
+    bool cancelled = false;
+    source.on_cancel([&cancelled]() {
+        cancelled = true;
+    });
+
+    auto next = source.then([](int value) {
+        return value + 1;
+    });
+    next.cancel();
+
+    EXPECT_TRUE(cancelled);
+    EXPECT_THROW(source.get(), Cancelled);
+    EXPECT_THROW(next.get(), Cancelled);
+}
+
+} // namespace
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <youtube/scope/fetch-plan.h>
+
+#include <gtest/gtest.h>
+
+using namespace youtube::scope;
+
+namespace {
+
+TEST(FetchPlan, unlimited_wants_everything) {
+    FetchPlan plan(0, 5);
+
+    EXPECT_TRUE(plan.unlimited());
+    EXPECT_EQ(5u, plan.per_source());
+    EXPECT_TRUE(plan.wants(100));
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_TRUE(plan.pushed());
+    }
+    EXPECT_FALSE(plan.met());
+}
+
+TEST(FetchPlan, stops_requests_when_enough_are_outstanding) {
+    FetchPlan plan(12, 5);
+
+    EXPECT_TRUE(plan.wants(0));
+    EXPECT_TRUE(plan.wants(2));
+    EXPECT_FALSE(plan.wants(3));
+}
+
+TEST(FetchPlan, asks_last_source_for_the_rest) {
+    FetchPlan plan(7, 5);
+
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_TRUE(plan.pushed());
+    }
+    EXPECT_EQ(2u, plan.remaining());
+    EXPECT_EQ(2u, plan.per_source());
+    EXPECT_TRUE(plan.pushed());
+    EXPECT_FALSE(plan.pushed());
+    EXPECT_TRUE(plan.met());
+    EXPECT_FALSE(plan.wants(0));
+}
+
+} // namespace
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <youtube/scope/number-formatter.h>
+
+#include <gtest/gtest.h>
+#include <climits>
+#include <locale>
+#include <sstream>
+#include <string>
+
+using namespace std;
+using namespace youtube::scope;
+
+namespace {
+
+class Punct: public numpunct<char> {
+public:
+    Punct(const string &grouping, char separator) :
+            grouping_(grouping), separator_(separator) {
+    }
+
+protected:
+    string do_grouping() const override {
+        return grouping_;
+    }
+
+    char do_thousands_sep() const override {
+        return separator_;
+    }
+
+    string grouping_;
+
+    char separator_;
+};
+
+locale with_punct(const string &grouping, char separator) {
+    return locale(locale::classic(), new Punct(grouping, separator));
+}
+
+string imbued(const locale &locale, long long number) {
+    ostringstream out;
+    out.imbue(locale);
+    out << number;
+    return out.str();
+}
+
+TEST(NumberFormatter, thousands) {
+    NumberFormatter formatter(with_punct("\3", ','));
+    EXPECT_EQ("0", formatter.format(0));
+    EXPECT_EQ("999", formatter.format(999));
+    EXPECT_EQ("1,000", formatter.format(1000));
+    EXPECT_EQ("1,234,567", formatter.format(1234567));
+    EXPECT_EQ("-1,234,567", formatter.format(-1234567));
+}
+
+TEST(NumberFormatter, ungrouped) {
+    NumberFormatter formatter(locale::classic());
+    EXPECT_EQ("1234567", formatter.format(1234567));
+}
+
+TEST(NumberFormatter, matches_stream_formatting) {
+    // Western, Indian and a grouping that stops after one group
+    for (const string &grouping : { string("\3"), string("\3\2"),
+            string("\3") + char(CHAR_MAX) }) {
+        locale locale(with_punct(grouping, '.'));
+        NumberFormatter formatter(locale);
+
+        for (long long number : { 0ll, 7ll, 12345ll, 1234567ll, 123456789012ll,
+                -98765ll, LLONG_MAX, LLONG_MIN }) {
+            EXPECT_EQ(imbued(locale, number), formatter.format(number));
+        }
+    }
+}
+
+} // namespace
@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <allocation-counter.h>
+
+#include <youtube/scope/number-formatter.h>
+#include <youtube/scope/result-cache.h>
+#include <youtube/scope/scope.h>
+
+#include <core/posix/exec.h>
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <unity/scopes/SearchReply.h>
+#include <unity/scopes/SearchReplyProxyFwd.h>
+#include <unity/scopes/testing/Category.h>
+#include <unity/scopes/testing/MockSearchReply.h>
+#include <unity/scopes/testing/TypedScopeFixture.h>
+
+using namespace std;
+using namespace testing;
+using namespace youtube;
+using namespace youtube::scope;
+
+namespace posix = core::posix;
+namespace sc = unity::scopes;
+namespace sct = unity::scopes::testing;
+
+namespace {
+
+typedef sct::TypedScopeFixture<Scope> TypedScopeFixtureScope;
+
+/**
+ * Upper bounds on the heap allocations made by the result pushing path.
+ * The bounds leave headroom over the counts at the time of writing, and
+ * exist to catch regressions such as a locale being built per call.
+ */
+class TestPushAllocations: public TypedScopeFixtureScope {
+protected:
+    void SetUp() override
+    {
+        fake_youtube_server_ = posix::exec(FAKE_YOUTUBE_SERVER, { }, { },
+                posix::StandardStream::stdout);
+
+        ASSERT_GT(fake_youtube_server_.pid(), 0);
+        string port;
+        fake_youtube_server_.cout() >> port;
+
+        string apiroot = "http://127.0.0.1:" + port;
+        setenv("YOUTUBE_SCOPE_APIROOT", apiroot.c_str(), true);
+
+        setenv("YOUTUBE_SCOPE_IGNORE_ACCOUNTS", "true", true);
+
+        // Replaying a recording does not go through push_resource
+        ResultCache::instance().clear();
+
+        TypedScopeFixture::set_scope_directory(TEST_SCOPE_DIRECTORY);
+        TypedScopeFixtureScope::SetUp();
+    }
+
+    /*
+     * The allocations made by the query thread between one push and the
+     * next, i.e. for each result after the first
+     */
+    vector<unsigned long> allocations_between_pushes(
+            const string &query_string, const string &department_id) {
+        vector<unsigned long> counts;
+
+        NiceMock<sct::MockSearchReply> reply;
+        ON_CALL(reply, register_category(_, _, _, _)).WillByDefault(
+                Invoke([](const string &id, const string &title,
+                        const string &icon, const sc::CategoryRenderer &renderer) {
+                    return make_shared<sct::Category>(id, title, icon, renderer);
+                }));
+        ON_CALL(reply, push(Matcher<sc::CategorisedResult const&>(_))).WillByDefault(
+                Invoke([&counts](const sc::CategorisedResult &) {
+                    counts.emplace_back(AllocationCounter::thread_count());
+                    return true;
+                }));
+
+        sc::SearchReplyProxy reply_proxy(&reply, [](sc::SearchReply*) {});
+        sc::CannedQuery query(SCOPE_NAME, query_string, department_id);
+        sc::SearchMetadata meta_data("en_EN", "phone");
+        auto search_query = scope->search(query, meta_data);
+        search_query->run(reply_proxy);
+
+        vector<unsigned long> deltas;
+        for (size_t i = 1; i < counts.size(); ++i) {
+            deltas.emplace_back(counts[i] - counts[i - 1]);
+        }
+        return deltas;
+    }
+
+    posix::ChildProcess fake_youtube_server_ = posix::ChildProcess::invalid();
+};
+
+TEST_F(TestPushAllocations, videos) {
+    auto deltas = allocations_between_pushes("banana", "");
+    ASSERT_FALSE(deltas.empty());
+    for (unsigned long delta : deltas) {
+        EXPECT_LE(delta, 300ul);
+    }
+}
+
+TEST_F(TestPushAllocations, channels) {
+    // Channel results link to a department, built with DepartmentPath
+    auto deltas = allocations_between_pushes("",
+            "guideCategory-channels:GCTXVzaWM");
+    ASSERT_FALSE(deltas.empty());
+    for (unsigned long delta : deltas) {
+        EXPECT_LE(delta, 300ul);
+    }
+}
+
+TEST(FormatFixedAllocations, cached_locale) {
+    format_fixed(1);
+
+    CountAllocations counter;
+    static const unsigned int CALLS = 100;
+    for (unsigned int i = 0; i < CALLS; ++i) {
+        format_fixed(1234567);
+    }
+
+    // At most the string itself, the locale is not rebuilt per call
+    EXPECT_LE(counter.count() / CALLS, 1ul);
+}
+
+} // namespace
@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <youtube/scope/subscription-index.h>
+
+#include <core/posix/exec.h>
+#include <gtest/gtest.h>
+#include <json/json.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+using namespace std;
+using namespace youtube::api;
+using namespace youtube::scope;
+
+namespace posix = core::posix;
+
+namespace {
+
+Subscription::Ptr make_subscription(const string &id, const string &channel_id) {
+    Json::Value data;
+    data["kind"] = "youtube#subscription";
+    data["id"] = id;
+    data["snippet"]["resourceId"]["channelId"] = channel_id;
+    return make_shared<Subscription>(data);
+}
+
+/*
+ * A client signed in to whichever account the test says, which never
+ * hears back from the server
+ */
+class AccountClient: public Client {
+public:
+    AccountClient() :
+            Client(nullptr) {
+    }
+
+    bool authenticated() override {
+        return true;
+    }
+
+    string account_id() override {
+        lock_guard<mutex> lock(mutex_);
+        return account_id_;
+    }
+
+    void sign_in(const string &account_id) {
+        lock_guard<mutex> lock(mutex_);
+        account_id_ = account_id;
+    }
+
+    Task<SubscriptionList> all_subscription_channels() override {
+        ++reconciles;
+        return Task<SubscriptionList>();
+    }
+
+    atomic<int> reconciles { 0 };
+
+protected:
+    string account_id_ = "1";
+
+    mutex mutex_;
+};
+
+class TestSubscriptionIndex: public testing::Test {
+protected:
+    TestSubscriptionIndex() :
+            client_(make_shared<AccountClient>()), index_(
+                    make_shared<SubscriptionIndex>(client_,
+                            chrono::seconds(600))) {
+        index_->load( { make_subscription("sub1", "UC1"), make_subscription(
+                "sub2", "UC2") }, index_->version(), "1");
+    }
+
+    shared_ptr<AccountClient> client_;
+
+    SubscriptionIndex::Ptr index_;
+};
+
+TEST_F(TestSubscriptionIndex, answers_from_loaded_subscriptions) {
+    string subscription_id;
+    ASSERT_TRUE(index_->lookup("UC2", subscription_id));
+    EXPECT_EQ("sub2", subscription_id);
+
+    ASSERT_TRUE(index_->lookup("UC3", subscription_id));
+    EXPECT_EQ("", subscription_id);
+}
+
+TEST_F(TestSubscriptionIndex, follows_actions) {
+    index_->subscribed("UC3", "sub3");
+    index_->unsubscribed("sub1");
+
+    string subscription_id;
+    ASSERT_TRUE(index_->lookup("UC3", subscription_id));
+    EXPECT_EQ("sub3", subscription_id);
+    ASSERT_TRUE(index_->lookup("UC1", subscription_id));
+    EXPECT_EQ("", subscription_id);
+}
+
+TEST_F(TestSubscriptionIndex, ignores_reconcile_overtaken_by_action) {
+    // Fetched before the user subscribed, so it is missing UC3
+    unsigned long version = index_->version();
+    index_->subscribed("UC3", "sub3");
+    index_->load( { make_subscription("sub1", "UC1") }, version, "1");
+
+    string subscription_id;
+    ASSERT_TRUE(index_->lookup("UC3", subscription_id));
+    EXPECT_EQ("sub3", subscription_id);
+}
+
+TEST_F(TestSubscriptionIndex, dropped_when_the_account_changes) {
+    client_->sign_in("2");
+
+    string subscription_id;
+    EXPECT_FALSE(index_->lookup("UC2", subscription_id));
+    EXPECT_EQ(1, client_->reconciles);
+
+    index_->load( { make_subscription("sub3", "UC3") }, index_->version(),
+            "2");
+    ASSERT_TRUE(index_->lookup("UC2", subscription_id));
+    EXPECT_EQ("", subscription_id);
+    ASSERT_TRUE(index_->lookup("UC3", subscription_id));
+    EXPECT_EQ("sub3", subscription_id);
+}
+
+/*
+ * A signed in client that holds the reconcile continuation, on the parser
+ * pool, until the test lets it go
+ */
+class HeldClient: public Client {
+public:
+    struct Gate {
+        promise<void> entered;
+
+        promise<void> released;
+    };
+
+    HeldClient(const shared_ptr<Gate> &gate) :
+            Client(nullptr), gate_(gate) {
+    }
+
+    bool authenticated() override {
+        return true;
+    }
+
+    Task<bool> prefetch_uploads(const vector<string> &) override {
+        gate_->entered.set_value();
+        gate_->released.get_future().wait();
+        return Task<bool>::ready(true);
+    }
+
+protected:
+    shared_ptr<Gate> gate_;
+};
+
+class TestSubscriptionIndexServer: public testing::Test {
+protected:
+    void SetUp() override {
+        fake_youtube_server_ = posix::exec(FAKE_YOUTUBE_SERVER, { }, { },
+                posix::StandardStream::stdout);
+
+        ASSERT_GT(fake_youtube_server_.pid(), 0);
+        string port;
+        fake_youtube_server_.cout() >> port;
+
+        string apiroot = "http://127.0.0.1:" + port;
+        setenv("YOUTUBE_SCOPE_APIROOT", apiroot.c_str(), true);
+        setenv("YOUTUBE_SCOPE_IGNORE_ACCOUNTS", "true", true);
+    }
+
+    static unsigned long parsed() {
+        return Client(nullptr).parse_stats().completed;
+    }
+
+    posix::ChildProcess fake_youtube_server_ = posix::ChildProcess::invalid();
+};
+
+TEST_F(TestSubscriptionIndexServer, destroyed_during_reconcile) {
+    auto gate = make_shared<HeldClient::Gate>();
+    auto index = make_shared<SubscriptionIndex>(make_shared<HeldClient>(gate),
+            chrono::seconds(600));
+    unsigned long before = parsed();
+
+    index->reconcile();
+    ASSERT_EQ(future_status::ready,
+            gate->entered.get_future().wait_for(chrono::seconds(10)));
+
+    // Now the continuation holds the last reference, so the client is
+    // destroyed from inside its own parse job
+    index.reset();
+    gate->released.set_value();
+
+    auto deadline = chrono::steady_clock::now() + chrono::seconds(10);
+    while (parsed() == before && chrono::steady_clock::now() < deadline) {
+        this_thread::sleep_for(chrono::milliseconds(10));
+    }
+    EXPECT_LT(before, parsed());
+}
+
+} // namespace
@@ -16,18 +16,31 @@
  * Author: Pete Woods <pete.woods@canonical.com>
  */
 
+#include <youtube/api/client.h>
+#include <youtube/api/uploads-cache.h>
+#include <youtube/scope/chart-cache.h>
+#include <youtube/scope/department-cache.h>
+#include <youtube/scope/result-cache.h>
 #include <youtube/scope/scope.h>
 
 #include <core/posix/exec.h>
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
+#include <chrono>
+#include <future>
 #include <iostream>
+#include <map>
 #include <string>
+#include <vector>
+#include <unity/scopes/ActionMetadata.h>
+#include <unity/scopes/PreviewReplyProxyFwd.h>
 #include <unity/scopes/SearchReply.h>
 #include <unity/scopes/SearchReplyProxyFwd.h>
 #include <unity/scopes/Variant.h>
 #include <unity/scopes/testing/Category.h>
+#include <unity/scopes/testing/MockPreviewReply.h>
 #include <unity/scopes/testing/MockSearchReply.h>
+#include <unity/scopes/testing/Result.h>
 #include <unity/scopes/testing/TypedScopeFixture.h>
 #include <unity/scopes/testing/ScopeMetadataBuilder.h>
 
@@ -35,6 +48,7 @@ using namespace std;
 using namespace testing;
 using namespace youtube::scope;
 
+namespace api = youtube::api;
 namespace posix = core::posix;
 namespace sc = unity::scopes;
 namespace sct = unity::scopes::testing;
@@ -80,9 +94,21 @@ typedef sct::TypedScopeFixture<Scope> TypedScopeFixtureScope;
 
 class TestYoutubeScope: public TypedScopeFixtureScope {
 protected:
+    /*
+     * Fault injection settings for the fake server, see Faults in server.py
+     */
+    virtual string faults() {
+        return "";
+    }
+
     void SetUp() override
     {
-        fake_youtube_server_ = posix::exec(FAKE_YOUTUBE_SERVER, { }, { },
+        vector<string> arguments;
+        if (!faults().empty()) {
+            arguments.emplace_back("--faults=" + faults());
+        }
+
+        fake_youtube_server_ = posix::exec(FAKE_YOUTUBE_SERVER, arguments, { },
                 posix::StandardStream::stdout);
 
         ASSERT_GT(fake_youtube_server_.pid(), 0);
@@ -94,6 +120,13 @@ protected:
 
         setenv("YOUTUBE_SCOPE_IGNORE_ACCOUNTS", "true", true);
 
+        // Each test has its own server, so must not see what the others
+        // recorded
+        ResultCache::instance().clear();
+        DepartmentCache::instance().clear();
+        ChartCache::instance().clear();
+        api::UploadsCache::instance().clear();
+
         // Do the parent SetUp
         TypedScopeFixture::set_scope_directory(TEST_SCOPE_DIRECTORY);
         TypedScopeFixtureScope::SetUp();
@@ -1027,17 +1060,8 @@ TEST_F(TestYoutubeScope, surface_music) {
 
     sc::CannedQuery query(SCOPE_NAME, "", "aggregated:musicaggregator"); // pick the music department
 
-    sc::Department::SPtr departments = sc::Department::create("", query,
-                "Best of YouTube");
-    add_department(departments, "GCRmVhdHVyZWQ", "Featured", query);
-    add_department(departments, "GCUGFpZCBDaGFubmVscw", "Paid Channels", query);
-    add_department(departments, "GCTXVzaWM", "Music", query);
-    add_department(departments, "GCQ29tZWR5", "Comedy", query);
-    departments->add_subdepartment(
-            sc::Department::create("aggregated:musicaggregator", query, " "));
-
-    EXPECT_CALL(reply, register_departments(IsDepartment(departments))).Times(
-            1);
+    // Aggregating scopes only get the chart
+    EXPECT_CALL(reply, register_departments(_)).Times(0);
 
     expect_category(reply, renderer, "youtube", "YouTube");
 
@@ -1089,6 +1113,25 @@ TEST_F(TestYoutubeScope, surface_music) {
     search_query->run(reply_proxy);
 }
 
+TEST_F(TestYoutubeScope, refused_push_stops_query) {
+    const sc::CategoryRenderer renderer;
+    NaggyMock<sct::MockSearchReply> reply;
+
+    sc::CannedQuery query(SCOPE_NAME, "", "aggregated:musicaggregator");
+
+    expect_category(reply, renderer, "youtube", "YouTube");
+
+    // The shell has stopped listening, so nothing else should be pushed
+    EXPECT_CALL(reply, push(Matcher<sc::CategorisedResult const&>(_))).WillOnce(
+            Return(false));
+
+    sc::SearchReplyProxy reply_proxy(&reply, [](sc::SearchReply*) {}); // note: this is a std::shared_ptr with empty deleter
+    sc::SearchMetadata meta_data("en_EN", "phone");
+    auto search_query = scope->search(query, meta_data);
+    ASSERT_NE(nullptr, search_query);
+    search_query->run(reply_proxy);
+}
+
 TEST_F(TestYoutubeScope, search_music) {
     const sc::CategoryRenderer renderer;
     NaggyMock<sct::MockSearchReply> reply;
@@ -1145,4 +1188,149 @@ TEST_F(TestYoutubeScope, search_music) {
     search_query->run(reply_proxy);
 }
 
+TEST_F(TestYoutubeScope, repeated_query_is_replayed) {
+    auto run_query = [this]() {
+        vector<string> uris;
+
+        NiceMock<sct::MockSearchReply> reply;
+        ON_CALL(reply, register_category(_, _, _, _)).WillByDefault(
+                Invoke([](const string &id, const string &title,
+                        const string &icon, const sc::CategoryRenderer &renderer) {
+                    return make_shared<sct::Category>(id, title, icon, renderer);
+                }));
+        ON_CALL(reply, push(Matcher<sc::CategorisedResult const&>(_))).WillByDefault(
+                Invoke([&uris](const sc::CategorisedResult &result) {
+                    uris.emplace_back(result.uri());
+                    return true;
+                }));
+
+        sc::CannedQuery query(SCOPE_NAME, "banana", "");
+        sc::SearchReplyProxy reply_proxy(&reply, [](sc::SearchReply*) {}); // note: this is a std::shared_ptr with empty deleter
+        sc::SearchMetadata meta_data("en_EN", "phone");
+        auto search_query = scope->search(query, meta_data);
+        search_query->run(reply_proxy);
+        return uris;
+    };
+
+    auto first = run_query();
+    ASSERT_EQ(5u, first.size());
+
+    // Nothing listens here, so the second answer can only be a replay
+    setenv("YOUTUBE_SCOPE_APIROOT", "http://127.0.0.1:1", true);
+    EXPECT_EQ(first, run_query());
+}
+
+TEST_F(TestYoutubeScope, prefetched_uploads_are_reused) {
+    auto channels_endpoint = []() {
+        auto metrics = api::Client(nullptr).metrics();
+        return metrics["channels"];
+    };
+
+    // What a reconcile does with the music channels the user subscribed to
+    api::Client client(nullptr);
+    auto prefetched = client.prefetch_uploads( { "UCdI8evszfZvyAl2UVCypkTA",
+            "UC20vb-R_px4CguHzzBPhoyQ", "UC_TVqp_SyG6j5hG-xVRy95A",
+            "UCpDJl2EmP7Oh90Vylx0dZtA", "UCrDkAvwZum-UTjHmzDI2iIw" });
+    ASSERT_EQ(future_status::ready, prefetched.wait_for(chrono::seconds(10)));
+    EXPECT_EQ(5u, api::UploadsCache::instance().size());
+    auto before = channels_endpoint();
+
+    NiceMock<sct::MockSearchReply> reply;
+    ON_CALL(reply, register_category(_, _, _, _)).WillByDefault(
+            Invoke([](const string &id, const string &title,
+                    const string &icon, const sc::CategoryRenderer &renderer) {
+                return make_shared<sct::Category>(id, title, icon, renderer);
+            }));
+    ON_CALL(reply, push(Matcher<sc::CategorisedResult const&>(_))).WillByDefault(
+            Return(true));
+
+    sc::CannedQuery query(SCOPE_NAME, "", "guideCategory-videos:GCTXVzaWM");
+    sc::SearchReplyProxy reply_proxy(&reply, [](sc::SearchReply*) {}); // note: this is a std::shared_ptr with empty deleter
+    sc::SearchMetadata meta_data("en_EN", "phone");
+    auto search_query = scope->search(query, meta_data);
+    ASSERT_NE(nullptr, search_query);
+    search_query->run(reply_proxy);
+
+    // Only the category's channels were listed, every channel's uploads
+    // playlist came from the cache
+    auto after = channels_endpoint();
+    EXPECT_EQ(before.requests + 1, after.requests);
+    EXPECT_EQ(before.cache_hits + 5, after.cache_hits);
+}
+
+TEST_F(TestYoutubeScope, video_preview_only_fetches_statistics) {
+    auto requests = []() {
+        map<string, unsigned long> counts;
+        for (const auto &endpoint : api::Client(nullptr).metrics()) {
+            counts[endpoint.first] = endpoint.second.requests;
+        }
+        return counts;
+    };
+
+    // A video result from a search already carries everything else the
+    // preview shows
+    sct::Result result;
+    result.set_uri("KnL2RJZTdA4");
+    result.set_title("Video title");
+    result.set_art("https://i.ytimg.com/vi/KnL2RJZTdA4/hqdefault.jpg");
+    result["kind"] = "youtube#video";
+    result["link"] = "http://www.youtube.com/watch?v=KnL2RJZTdA4";
+    result["subtitle"] = "Channel title";
+    result["channel_id"] = "UCrDkAvwZum-UTjHmzDI2iIw";
+    result["published_at"] = "2014-09-05T13:00:02.000Z";
+
+    auto before = requests();
+
+    NiceMock<sct::MockPreviewReply> reply;
+    EXPECT_CALL(reply, push(Matcher<sc::PreviewWidgetList const&>(_))).Times(
+            AtLeast(1)).WillRepeatedly(Return(true));
+
+    sc::PreviewReplyProxy reply_proxy(&reply, [](sc::PreviewReply*) {}); // note: this is a std::shared_ptr with empty deleter
+    sc::ActionMetadata meta_data("en_EN", "phone");
+    auto preview_query = scope->preview(result, meta_data);
+    ASSERT_NE(nullptr, preview_query);
+    preview_query->run(reply_proxy);
+
+    // The one request was for the video's statistics, nothing else was
+    // looked up again
+    auto after = requests();
+    EXPECT_EQ(before["videos"] + 1, after["videos"]);
+    after["videos"] -= 1;
+    EXPECT_EQ(before, after);
+}
+
+TEST_F(TestYoutubeScope, cancelled_query) {
+    StrictMock<sct::MockSearchReply> reply;
+
+    sc::CannedQuery query(SCOPE_NAME, "banana", "");
+
+    // Nothing is registered or pushed once the query is cancelled
+    sc::SearchReplyProxy reply_proxy(&reply, [](sc::SearchReply*) {}); // note: this is a std::shared_ptr with empty deleter
+    sc::SearchMetadata meta_data("en_EN", "phone");
+    auto search_query = scope->search(query, meta_data);
+    ASSERT_NE(nullptr, search_query);
+    search_query->cancelled();
+    search_query->run(reply_proxy);
+}
+
+class TestYoutubeScopeServerErrors: public TestYoutubeScope {
+protected:
+    string faults() override {
+        return R"({"endpoints": {"search": {"error_rate": 1.0, "error_status": 503}}})";
+    }
+};
+
+TEST_F(TestYoutubeScopeServerErrors, failed_search) {
+    StrictMock<sct::MockSearchReply> reply;
+
+    sc::CannedQuery query(SCOPE_NAME, "banana", "");
+
+    // The error object is logged, and nothing is registered or pushed
+    sc::SearchReplyProxy reply_proxy(&reply, [](sc::SearchReply*) {}); // note: this is a std::shared_ptr with empty deleter
+    sc::SearchMetadata meta_data("en_EN", "phone");
+    auto search_query = scope->search(query, meta_data);
+    ASSERT_NE(nullptr, search_query);
+    search_query->run(reply_proxy);
+}
+
 } // namespace
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "allocation-counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+
+namespace {
+
+thread_local unsigned long thread_allocations = 0;
+
+atomic<unsigned long> total_allocations(0);
+
+void *allocate(size_t size) {
+    ++thread_allocations;
+    total_allocations.fetch_add(1, memory_order_relaxed);
+    return malloc(size == 0 ? 1 : size);
+}
+
+}
+
+unsigned long youtube::AllocationCounter::thread_count() {
+    return thread_allocations;
+}
+
+unsigned long youtube::AllocationCounter::total() {
+    return total_allocations.load(memory_order_relaxed);
+}
+
+void *operator new(size_t size) {
+    void *p = allocate(size);
+    if (!p) {
+        throw bad_alloc();
+    }
+    return p;
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void *operator new(size_t size, const nothrow_t &) noexcept {
+    return allocate(size);
+}
+
+void *operator new[](size_t size, const nothrow_t &) noexcept {
+    return allocate(size);
+}
+
+void operator delete(void *p) noexcept {
+    free(p);
+}
+
+void operator delete[](void *p) noexcept {
+    free(p);
+}
+
+void operator delete(void *p, const nothrow_t &) noexcept {
+    free(p);
+}
+
+void operator delete[](void *p, const nothrow_t &) noexcept {
+    free(p);
+}
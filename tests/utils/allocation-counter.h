@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2014 Canonical, Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of version 3 of the GNU Lesser General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef YOUTUBE_TESTS_ALLOCATION_COUNTER_H_
+#define YOUTUBE_TESTS_ALLOCATION_COUNTER_H_
+
+namespace youtube {
+
+/**
+ * Counts heap allocations made through operator new.
+ *
+ * Linking allocation-counter.cpp into a binary replaces the global
+ * operator new and delete for the whole process, so only test and
+ * benchmark binaries should do so.
+ */
+class AllocationCounter {
+public:
+    /*
+     * Allocations made so far by the calling thread
+     */
+    static unsigned long thread_count();
+
+    /*
+     * Allocations made so far by every thread
+     */
+    static unsigned long total();
+};
+
+/**
+ * The allocations made by the calling thread while this is in scope
+ */
+class CountAllocations {
+public:
+    CountAllocations() :
+            start_(AllocationCounter::thread_count()) {
+    }
+
+    unsigned long count() const {
+        return AllocationCounter::thread_count() - start_;
+    }
+
+protected:
+    unsigned long start_;
+};
+
+}
+
+#endif // YOUTUBE_TESTS_ALLOCATION_COUNTER_H_